@@ -18,18 +18,15 @@
 
 #include <assert.h>
 #include <stdint.h>
-
-#ifdef USE_PEXT
-    #include <immintrin.h> // for _pext_u64() intrinsic
-#endif
+#include <time.h>
 
 #include "attacks.h"
 #include "bitboards.h"
 #include "types.h"
 
-static uint64_t PawnAttacks[COLOUR_NB][SQUARE_NB];
-static uint64_t KnightAttacks[SQUARE_NB];
-static uint64_t KingAttacks[SQUARE_NB];
+uint64_t PawnAttacks[COLOUR_NB][SQUARE_NB];
+uint64_t KnightAttacks[SQUARE_NB];
+uint64_t KingAttacks[SQUARE_NB];
 
 const uint64_t RookMagic[SQUARE_NB] = {
     0xA180022080400230ull, 0x0040100040022000ull, 0x0080088020001002ull, 0x0080080280841000ull,
@@ -70,10 +67,21 @@ const uint64_t BishopMagic[SQUARE_NB] = {
 };
 
 static uint64_t RookAttacks[0x19000], BishopAttacks[0x1480];
-static uint64_t *BishopAttacksPtr[SQUARE_NB], *RookAttacksPtr[SQUARE_NB];
+uint64_t *BishopAttacksPtr[SQUARE_NB], *RookAttacksPtr[SQUARE_NB];
+
+uint64_t BishopMask[SQUARE_NB], RookMask[SQUARE_NB];
+unsigned BishopShift[SQUARE_NB], RookShift[SQUARE_NB];
+
+// Lines through each square, excluding the square itself, and the attacks
+// along the first rank for each file and inner occupancy. These 2KB are
+// all that the compact sliders need, in place of the 820KB magic tables
+uint64_t DiagonalMask[SQUARE_NB], AntiDiagonalMask[SQUARE_NB], FileMask[SQUARE_NB];
+uint8_t RankAttacks[FILE_NB][64];
+
+const char *SliderNames[SLIDER_NB] = { "Magic", "PEXT", "Compact" };
 
-static uint64_t BishopMask[SQUARE_NB], RookMask[SQUARE_NB];
-static unsigned BishopShift[SQUARE_NB], RookShift[SQUARE_NB];
+int SliderMode = SLIDER_MAGIC;
+static int TableMode = -1; // Indexing used to fill the magic tables
 
 static uint64_t sliderAttacks(int s, uint64_t occ, const int dir[4][2]) {
 
@@ -97,16 +105,6 @@ static uint64_t sliderAttacks(int s, uint64_t occ, const int dir[4][2]) {
     return result;
 }
 
-static int sliderIndex(uint64_t occ, uint64_t mask, uint64_t magic, unsigned shift) {
-
-#ifdef USE_PEXT
-    (void)magic, (void)shift;  // Silence compiler warnings (unused variables)
-    return _pext_u64(occ, mask);
-#else
-    return ((occ & mask) * magic) >> shift;
-#endif
-}
-
 static void initSliderAttacks(int s, uint64_t mask[SQUARE_NB], const uint64_t magic[SQUARE_NB],
     unsigned shift[SQUARE_NB], uint64_t *attacksPtr[SQUARE_NB], const int dir[4][2]) {
 
@@ -128,35 +126,43 @@ static void initSliderAttacks(int s, uint64_t mask[SQUARE_NB], const uint64_t ma
     } while (occ);
 }
 
-static void setSquare(uint64_t *bb, int r, int f) {
+static void setSquareIfValid(uint64_t *bb, int r, int f) {
     if (0 <= r && r < RANK_NB && 0 <= f && f < FILE_NB)
         setBit(bb, square(r, f));
 }
 
-void initAttacks() {
+static void initCompactAttacks() {
 
-    const int PawnDir[2][2] = {{1,-1}, {1,1}};
-    const int KnightDir[8][2] = {{-2,-1}, {-2,1}, {-1,-2}, {-1,2}, {1,-2}, {1,2}, {2,-1}, {2,1}};
-    const int BishopDir[4][2] = {{-1,-1}, {-1,1}, {1,-1}, {1,1}};
     const int RookDir[4][2] = {{-1,0}, {0,-1}, {0,1}, {1,0}};
-    const int KingDir[8][2] = {{-1,-1}, {-1,0}, {-1,1}, {0,-1}, {0,1}, {1,-1}, {1,0}, {1,1}};
 
-    // Initialise Pawn, Knight, and King attacks
     for (int s = 0; s < SQUARE_NB; s++) {
-        const int r = rankOf(s), f = fileOf(s);
+        for (int t = 0; t < SQUARE_NB; t++) {
 
-        for (int d = 0; d < 2; d++) {
-            setSquare(&PawnAttacks[WHITE][s], r + PawnDir[d][0], f + PawnDir[d][1]);
-            setSquare(&PawnAttacks[BLACK][s], r - PawnDir[d][0], f - PawnDir[d][1]);
-        }
+            if (s == t) continue;
 
-        for (int d = 0; d < 8; d++) {
-            setSquare(&KnightAttacks[s], r + KnightDir[d][0], f + KnightDir[d][1]);
-            setSquare(&KingAttacks[s], r + KingDir[d][0], f + KingDir[d][1]);
+            if (rankOf(s) - fileOf(s) == rankOf(t) - fileOf(t))
+                setBit(&DiagonalMask[s], t);
+
+            if (rankOf(s) + fileOf(s) == rankOf(t) + fileOf(t))
+                setBit(&AntiDiagonalMask[s], t);
+
+            if (fileOf(s) == fileOf(t))
+                setBit(&FileMask[s], t);
         }
     }
 
-    // Initialise Bishop, Rook, and Queen attacks
+    for (int f = 0; f < FILE_NB; f++)
+        for (int occ = 0; occ < 64; occ++)
+            RankAttacks[f][occ] = sliderAttacks(f, (uint64_t)occ << 1, RookDir) & RANK_1;
+}
+
+static void initMagicAttacks() {
+
+    const int BishopDir[4][2] = {{-1,-1}, {-1,1}, {1,-1}, {1,1}};
+    const int RookDir[4][2] = {{-1,0}, {0,-1}, {0,1}, {1,0}};
+
+    // The magic and PEXT indexing share the same tables, laid out
+    // differently, so the tables are filled for the current SliderMode
     BishopAttacksPtr[0] = BishopAttacks;
     RookAttacksPtr[0] = RookAttacks;
 
@@ -166,33 +172,113 @@ void initAttacks() {
     }
 }
 
-uint64_t pawnAttacks(int c, int s) {
-    assert(0 <= c && c < COLOUR_NB);
-    assert(0 <= s && s < SQUARE_NB);
-    return PawnAttacks[c][s];
+static double timeSliderMode(int mode) {
+
+    uint64_t seed = 0x9E3779B97F4A7C15ull, occupancies[1024];
+    volatile uint64_t sink = 0;
+    double best = 1e30;
+
+    setSliderMode(mode);
+
+    // Random occupancies with roughly a quarter of the squares filled
+    for (int i = 0; i < 1024; i++) {
+        uint64_t occ = ~0ull;
+        for (int j = 0; j < 2; j++) {
+            seed ^= seed << 13, seed ^= seed >> 7, seed ^= seed << 17;
+            occ &= seed;
+        }
+        occupancies[i] = occ;
+    }
+
+    // Take the best of several runs to filter out scheduling noise
+    for (int run = 0; run < 5; run++) {
+
+        clock_t start = clock();
+
+        for (int i = 0; i < 1024; i++)
+            for (int s = 0; s < SQUARE_NB; s++)
+                sink ^= bishopAttacks(s, occupancies[i]) ^ rookAttacks(s, occupancies[i]);
+
+        best = MIN(best, (double)(clock() - start));
+    }
+
+    return best;
 }
 
-uint64_t knightAttacks(int s) {
-    assert(0 <= s && s < SQUARE_NB);
-    return KnightAttacks[s];
+void initAttacks() {
+
+    const int PawnDir[2][2] = {{1,-1}, {1,1}};
+    const int KnightDir[8][2] = {{-2,-1}, {-2,1}, {-1,-2}, {-1,2}, {1,-2}, {1,2}, {2,-1}, {2,1}};
+    const int KingDir[8][2] = {{-1,-1}, {-1,0}, {-1,1}, {0,-1}, {0,1}, {1,-1}, {1,0}, {1,1}};
+
+    // Initialise Pawn, Knight, and King attacks
+    for (int s = 0; s < SQUARE_NB; s++) {
+        const int r = rankOf(s), f = fileOf(s);
+
+        for (int d = 0; d < 2; d++) {
+            setSquareIfValid(&PawnAttacks[WHITE][s], r + PawnDir[d][0], f + PawnDir[d][1]);
+            setSquareIfValid(&PawnAttacks[BLACK][s], r - PawnDir[d][0], f - PawnDir[d][1]);
+        }
+
+        for (int d = 0; d < 8; d++) {
+            setSquareIfValid(&KnightAttacks[s], r + KnightDir[d][0], f + KnightDir[d][1]);
+            setSquareIfValid(&KingAttacks[s], r + KingDir[d][0], f + KingDir[d][1]);
+        }
+    }
+
+    // Initialise Bishop, Rook, and Queen attacks using the fastest scheme
+    initCompactAttacks();
+    setSliderMode(selectSliderMode());
 }
 
-uint64_t bishopAttacks(int s, uint64_t occ) {
-    assert(0 <= s && s < SQUARE_NB);
-    return BishopAttacksPtr[s][sliderIndex(occ, BishopMask[s], BishopMagic[s], BishopShift[s])];
+int sliderModeSupported(int mode) {
+
+#if defined(USE_PEXT)
+    return mode == SLIDER_PEXT;
+#elif defined(__GNUC__) && defined(__x86_64__)
+    if (mode == SLIDER_PEXT)
+        return __builtin_cpu_supports("bmi2");
+#else
+    if (mode == SLIDER_PEXT)
+        return 0;
+#endif
+
+    return 0 <= mode && mode < SLIDER_NB;
 }
 
-uint64_t rookAttacks(int s, uint64_t occ) {
-    assert(0 <= s && s < SQUARE_NB);
-    return RookAttacksPtr[s][sliderIndex(occ, RookMask[s], RookMagic[s], RookShift[s])];
+int selectSliderMode() {
+
+#if defined(USE_PEXT)
+    return SLIDER_PEXT; // Fixed by the build, see SLIDER_MODE
+#endif
+
+    int bestMode = SLIDER_MAGIC;
+    double bestTime = timeSliderMode(SLIDER_MAGIC);
+
+    for (int mode = SLIDER_MAGIC + 1; mode < SLIDER_NB; mode++) {
+
+        if (!sliderModeSupported(mode))
+            continue;
+
+        double elapsed = timeSliderMode(mode);
+        if (elapsed < bestTime)
+            bestMode = mode, bestTime = elapsed;
+    }
+
+    return bestMode;
 }
 
-uint64_t queenAttacks(int s, uint64_t occ) {
-    assert(0 <= s && s < SQUARE_NB);
-    return rookAttacks(s, occ) | bishopAttacks(s, occ);
+int getSliderMode() {
+    return SliderMode;
 }
 
-uint64_t kingAttacks(int s) {
-    assert(0 <= s && s < SQUARE_NB);
-    return KingAttacks[s];
+void setSliderMode(int mode) {
+
+    assert(sliderModeSupported(mode));
+
+    SliderMode = mode;
+
+    // Refill the shared tables when switching between magic and PEXT
+    if (mode != SLIDER_COMPACT && mode != TableMode)
+        initMagicAttacks(), TableMode = mode;
 }
@@ -18,13 +18,139 @@
 
 #pragma once
 
+#include <assert.h>
 #include <stdint.h>
 
+#if defined(USE_PEXT) || (defined(__GNUC__) && defined(__x86_64__))
+    #include <immintrin.h> // for _pext_u64() intrinsic
+#endif
+
+#include "bitboards.h"
+#include "types.h"
+
+// Sliding attacks are found with one of three schemes, chosen at startup by
+// timing each on the host. Magic and PEXT index the same 820KB of tables,
+// while the compact scheme computes attacks from 2KB of line masks
+enum { SLIDER_MAGIC, SLIDER_PEXT, SLIDER_COMPACT, SLIDER_NB };
+
+extern const char *SliderNames[SLIDER_NB];
+extern int SliderMode;
+
+// PEXT builds fix the scheme at compile time, so that the lookups carry no
+// runtime branch. Generic and dispatch builds follow the choice at startup
+#if defined(USE_PEXT)
+    #define SLIDER_MODE SLIDER_PEXT
+#else
+    #define SLIDER_MODE SliderMode
+#endif
+
+extern uint64_t PawnAttacks[COLOUR_NB][SQUARE_NB];
+extern uint64_t KnightAttacks[SQUARE_NB];
+extern uint64_t KingAttacks[SQUARE_NB];
+
+extern const uint64_t BishopMagic[SQUARE_NB], RookMagic[SQUARE_NB];
+extern uint64_t *BishopAttacksPtr[SQUARE_NB], *RookAttacksPtr[SQUARE_NB];
+extern uint64_t BishopMask[SQUARE_NB], RookMask[SQUARE_NB];
+extern unsigned BishopShift[SQUARE_NB], RookShift[SQUARE_NB];
+
+extern uint64_t DiagonalMask[SQUARE_NB], AntiDiagonalMask[SQUARE_NB], FileMask[SQUARE_NB];
+extern uint8_t RankAttacks[FILE_NB][64];
+
 void initAttacks();
 
-uint64_t pawnAttacks(int c, int s);
-uint64_t knightAttacks(int s);
-uint64_t bishopAttacks(int s, uint64_t occ);
-uint64_t rookAttacks(int s, uint64_t occ);
-uint64_t queenAttacks(int s, uint64_t occ);
-uint64_t kingAttacks(int s);
+int sliderModeSupported(int mode);
+int selectSliderMode();
+int getSliderMode();
+void setSliderMode(int mode);
+
+#if defined(USE_PEXT)
+
+static inline uint64_t pextIndex(uint64_t occ, uint64_t mask) {
+    return _pext_u64(occ, mask);
+}
+
+#elif defined(__GNUC__) && defined(__x86_64__)
+
+// Built without -mbmi2, so PEXT is compiled for use only once
+// sliderModeSupported() has confirmed that the host implements it
+__attribute__((target("bmi2"))) static inline uint64_t pextIndex(uint64_t occ, uint64_t mask) {
+    return _pext_u64(occ, mask);
+}
+
+#else
+
+static inline uint64_t pextIndex(uint64_t occ, uint64_t mask) {
+
+    uint64_t index = 0;
+
+    for (uint64_t bit = 1; mask; mask &= mask - 1, bit <<= 1)
+        if (occ & mask & -mask) index |= bit;
+
+    return index;
+}
+
+#endif
+
+static inline int sliderIndex(uint64_t occ, uint64_t mask, uint64_t magic, unsigned shift) {
+
+    if (SLIDER_MODE == SLIDER_PEXT)
+        return pextIndex(occ, mask);
+
+    return ((occ & mask) * magic) >> shift;
+}
+
+static inline uint64_t hyperbolaAttacks(int s, uint64_t occ, uint64_t mask) {
+
+    // Hyperbola Quintessence: subtracting the slider borrows up to the first
+    // blocker above it, and the same on the byte swapped board finds the
+    // first blocker below it. Combined, the occupancy itself cancels out
+    const uint64_t forward = occ & mask;
+    const uint64_t reverse = __builtin_bswap64(forward);
+
+    return ( (forward - (1ull << s))
+           ^ __builtin_bswap64(reverse - (1ull << (s ^ 56)))) & mask;
+}
+
+static inline uint64_t compactBishopAttacks(int s, uint64_t occ) {
+    return hyperbolaAttacks(s, occ, DiagonalMask[s])
+         | hyperbolaAttacks(s, occ, AntiDiagonalMask[s]);
+}
+
+static inline uint64_t compactRookAttacks(int s, uint64_t occ) {
+    const int shift = s & 56;
+    return hyperbolaAttacks(s, occ, FileMask[s])
+         | (uint64_t)RankAttacks[fileOf(s)][(occ >> (shift + 1)) & 63] << shift;
+}
+
+static inline uint64_t pawnAttacks(int c, int s) {
+    assert(0 <= c && c < COLOUR_NB);
+    assert(0 <= s && s < SQUARE_NB);
+    return PawnAttacks[c][s];
+}
+
+static inline uint64_t knightAttacks(int s) {
+    assert(0 <= s && s < SQUARE_NB);
+    return KnightAttacks[s];
+}
+
+static inline uint64_t bishopAttacks(int s, uint64_t occ) {
+    assert(0 <= s && s < SQUARE_NB);
+    if (SLIDER_MODE == SLIDER_COMPACT) return compactBishopAttacks(s, occ);
+    return BishopAttacksPtr[s][sliderIndex(occ, BishopMask[s], BishopMagic[s], BishopShift[s])];
+}
+
+static inline uint64_t rookAttacks(int s, uint64_t occ) {
+    assert(0 <= s && s < SQUARE_NB);
+    if (SLIDER_MODE == SLIDER_COMPACT) return compactRookAttacks(s, occ);
+    return RookAttacksPtr[s][sliderIndex(occ, RookMask[s], RookMagic[s], RookShift[s])];
+}
+
+static inline uint64_t queenAttacks(int s, uint64_t occ) {
+    assert(0 <= s && s < SQUARE_NB);
+    return rookAttacks(s, occ) | bishopAttacks(s, occ);
+}
+
+static inline uint64_t kingAttacks(int s) {
+    assert(0 <= s && s < SQUARE_NB);
+    return KingAttacks[s];
+}
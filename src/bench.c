@@ -0,0 +1,451 @@
+/*
+  Ethereal is a UCI chess playing engine authored by Andrew Grant.
+  <https://github.com/AndyGrant/Ethereal>     <andrew@grantnet.us>
+
+  Ethereal is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Ethereal is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <inttypes.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "board.h"
+#include "evaluate.h"
+#include "move.h"
+#include "movegen.h"
+#include "movepicker.h"
+#include "search.h"
+#include "thread.h"
+#include "time.h"
+#include "transposition.h"
+#include "types.h"
+#include "uci.h"
+
+extern volatile int ABORT_SIGNAL; // Defined by Search.c
+extern int QuietInfo; // Defined by Uci.c
+
+static const char *Benchmarks[] = {
+    #include "bench.csv"
+    ""
+};
+
+static void initBenchLimits(Limits *limits, int depth, uint64_t nodeBudget) {
+
+    // Initialize limits for the search, either to a depth or, when given
+    // a node budget, to a fixed number of nodes for each position
+    limits->limitedByNone  = 0;
+    limits->limitedByTime  = 0;
+    limits->limitedByDepth = nodeBudget == 0;
+    limits->limitedByNodes = nodeBudget != 0;
+    limits->limitedByMate  = 0;
+    limits->limitedBySelf  = 0;
+    limits->timeLimit      = 0;
+    limits->depthLimit     = depth == 0 ? 13 : depth;
+    limits->nodeLimit      = nodeBudget;
+    limits->mateLimit      = 0;
+    limits->searchMoveCount = 0;
+}
+
+void runBenchmark(Thread *threads, int depth, uint64_t nodeBudget) {
+
+    double start, end;
+    Board board;
+    Limits limits;
+
+    uint64_t nodes = 0ull, lazyCalls = 0ull, lazyExits[LAZY_STAGE_NB] = {0};
+    uint16_t ponder;
+
+    initBenchLimits(&limits, depth, nodeBudget);
+
+    start = getRealTime();
+
+    // Search each benchmark position
+    for (int i = 0; strcmp(Benchmarks[i], ""); i++) {
+        printf("\nPosition #%d: %s\n", i + 1, Benchmarks[i]);
+        boardFromFEN(&board, Benchmarks[i]);
+
+        ABORT_SIGNAL = 0; // Clear the ABORT signal for the new search
+        limits.start = getRealTime();
+        getBestMove(threads, &board, &limits, &ponder);
+        nodes += nodesSearchedThreadPool(threads);
+
+        lazyCalls += lazyCallsSearchedThreadPool(threads);
+        for (int stage = 0; stage < LAZY_STAGE_NB; stage++)
+            lazyExits[stage] += lazyExitsSearchedThreadPool(threads, stage);
+
+        clearTT(); // Reset TT for new search
+    }
+
+    end = getRealTime();
+
+    printf("\n------------------------\n");
+    printf("Time  : %dms\n", (int)(end - start));
+    printf("Nodes : %"PRIu64"\n", nodes);
+    printf("NPS   : %d\n", (int)(nodes / ((end - start) / 1000.0)));
+    printf("Lazy  : %"PRIu64" evals, %"PRIu64" material exits, %"PRIu64" piece exits\n",
+        lazyCalls, lazyExits[LAZY_MATERIAL], lazyExits[LAZY_PIECES]);
+}
+
+static double studentT95(int samples) {
+
+    // Two sided 95% critical values of Student's t, by degrees of freedom
+    static const double Table[] = {
+        0.000, 12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+               2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+               2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042,
+    };
+
+    return samples - 1 <= 30 ? Table[samples - 1] : 1.960;
+}
+
+static void printBenchStats(const char *name, double *values, int count, const char *suffix) {
+
+    double mean = 0.0, variance = 0.0, stddev, ci95;
+
+    for (int i = 0; i < count; i++)
+        mean += values[i] / count;
+
+    for (int i = 0; i < count; i++)
+        variance += (values[i] - mean) * (values[i] - mean);
+
+    // Sample standard deviation, and the half width of the 95% confidence
+    // interval for the mean. Neither has any meaning for a single repeat
+    stddev = count > 1 ? sqrt(variance / (count - 1)) : 0.0;
+    ci95   = count > 1 ? studentT95(count) * stddev / sqrt(count) : 0.0;
+
+    printf("\"%s\": {\"mean\": %.3f, \"stddev\": %.3f, \"ci95\": %.3f}%s",
+        name, mean, stddev, ci95, suffix);
+}
+
+static void printJSONString(const char *str) {
+
+    // Quote a string, escaping what JSON does not allow to appear raw
+    putchar('"');
+
+    for (; *str; str++) {
+        if (*str == '"' || *str == '\\') printf("\\%c", *str);
+        else if ((unsigned char)*str < 0x20) printf("\\u%04x", (unsigned char)*str);
+        else putchar(*str);
+    }
+
+    putchar('"');
+}
+
+static int loadBenchPositions(const char *fname, char ***fens) {
+
+    FILE *fin;
+    char line[512], *start, *end;
+    int count = 0, capacity = 64;
+
+    *fens = malloc(capacity * sizeof(char*));
+
+    // Without a file, use our own copy of bench.csv
+    if (fname == NULL) {
+        for (; strcmp(Benchmarks[count], ""); count++) {
+            if (count == capacity) *fens = realloc(*fens, (capacity *= 2) * sizeof(char*));
+            (*fens)[count] = strdup(Benchmarks[count]);
+        }
+        return count;
+    }
+
+    if ((fin = fopen(fname, "r")) == NULL) {
+        fprintf(stderr, "Unable to open %s\n", fname);
+        return 0;
+    }
+
+    // Accept bench.csv's own format, one quoted FEN per line with a trailing
+    // comma, as well as plain FENs. Surrounding whitespace is ignored
+    while (fgets(line, sizeof(line), fin) != NULL) {
+
+        for (start = line; *start && strchr(" \t\"", *start); start++);
+        for (end = start + strlen(start); end > start && strchr(" \t\r\n\",", end[-1]); end--);
+        if (end == start) continue;
+
+        *end = '\0';
+        if (count == capacity) *fens = realloc(*fens, (capacity *= 2) * sizeof(char*));
+        (*fens)[count++] = strdup(start);
+    }
+
+    fclose(fin);
+    return count;
+}
+
+void runBenchmarkSuite(int argc, char **argv) {
+
+    enum { NODES, TIME, NPS, TTHITRATE, SELDEPTH, METRIC_NB };
+    static const char *Metrics[METRIC_NB] = { "nodes", "time", "nps", "tthitrate", "seldepth" };
+
+    Board board;
+    Limits limits;
+    Thread *threads;
+    char **fens, *fname = NULL;
+    double start, elapsed, *samples, *totals;
+    uint64_t nodes, probes, totalNodes, totalProbes, totalHits;
+    uint16_t ponder;
+    int count;
+
+    int nthreads = 1, megabytes = 16, depth = 0, repeats = 1;
+    uint64_t nodeBudget = 0ull;
+
+    // Options are given as key=value pairs, in any order
+    for (int i = 0; i < argc; i++) {
+
+        char *value = strchr(argv[i], '=');
+
+        if (value == NULL) {
+            fprintf(stderr, "Expected key=value, found %s\n", argv[i]);
+            return;
+        }
+
+        *value++ = '\0';
+
+        if      (stringEquals(argv[i], "threads")) nthreads   = MAX(1, atoi(value));
+        else if (stringEquals(argv[i], "hash"   )) megabytes  = MAX(1, atoi(value));
+        else if (stringEquals(argv[i], "depth"  )) depth      = MAX(0, atoi(value));
+        else if (stringEquals(argv[i], "nodes"  )) nodeBudget = strtoull(value, NULL, 10);
+        else if (stringEquals(argv[i], "repeats")) repeats    = MAX(1, atoi(value));
+        else if (stringEquals(argv[i], "file"   )) fname      = value;
+
+        else {
+            fprintf(stderr, "Unknown bench option %s\n", argv[i]);
+            return;
+        }
+    }
+
+    if ((count = loadBenchPositions(fname, &fens)) == 0) {
+        fprintf(stderr, "No positions to search\n");
+        return;
+    }
+
+    initTT(megabytes);
+    threads = createThreadPool(nthreads);
+    initBenchLimits(&limits, depth, nodeBudget);
+
+    // One sample per metric for each position and repeat, and for the totals
+    // of each repeat. The info lines would only get in the way of the JSON
+    samples = malloc(sizeof(double) * METRIC_NB * count * repeats);
+    totals  = malloc(sizeof(double) * METRIC_NB * repeats);
+    QuietInfo = 1;
+
+    for (int r = 0; r < repeats; r++) {
+
+        // Every repeat starts from the same state, so that the only
+        // differences between them are those of timing and threading
+        resetThreadPool(threads);
+        clearTT();
+
+        totalNodes = totalProbes = totalHits = 0ull;
+        elapsed = 0.0;
+
+        for (int i = 0; i < count; i++) {
+
+            double *sample = &samples[METRIC_NB * (i * repeats + r)];
+
+            fprintf(stderr, "\rRepeat %d/%d, position %d/%d", r + 1, repeats, i + 1, count);
+            boardFromFEN(&board, fens[i]);
+
+            ABORT_SIGNAL = 0; // Clear the ABORT signal for the new search
+            start = limits.start = getRealTime();
+            getBestMove(threads, &board, &limits, &ponder);
+            sample[TIME] = MAX(1.0, getRealTime() - start);
+
+            nodes  = nodesSearchedThreadPool(threads);
+            probes = ttprobesSearchedThreadPool(threads);
+
+            sample[NODES]     = nodes;
+            sample[NPS]       = nodes / (sample[TIME] / 1000.0);
+            sample[TTHITRATE] = probes ? (double)tthitsSearchedThreadPool(threads) / probes : 0.0;
+            sample[SELDEPTH]  = threads[0].seldepth;
+
+            totalNodes  += nodes;
+            totalProbes += probes;
+            totalHits   += tthitsSearchedThreadPool(threads);
+            elapsed     += sample[TIME];
+
+            clearTT(); // Reset TT for new search
+        }
+
+        totals[METRIC_NB * r + NODES]     = totalNodes;
+        totals[METRIC_NB * r + TIME]      = elapsed;
+        totals[METRIC_NB * r + NPS]       = totalNodes / (elapsed / 1000.0);
+        totals[METRIC_NB * r + TTHITRATE] = totalProbes ? (double)totalHits / totalProbes : 0.0;
+        totals[METRIC_NB * r + SELDEPTH]  = 0.0;
+    }
+
+    fprintf(stderr, "\n");
+    QuietInfo = 0;
+
+    printf("{\n");
+    printf("  \"threads\": %d,\n", nthreads);
+    printf("  \"hash\": %d,\n", megabytes);
+    printf("  \"depth\": %d,\n", nodeBudget ? 0 : limits.depthLimit);
+    printf("  \"nodes\": %"PRIu64",\n", nodeBudget);
+    printf("  \"repeats\": %d,\n", repeats);
+    printf("  \"file\": ");
+    printJSONString(fname ? fname : "bench.csv");
+    printf(",\n");
+    printf("  \"positions\": [\n");
+
+    // Each metric of a position is summarised across all of the repeats
+    for (int i = 0; i < count; i++) {
+
+        printf("    {\"fen\": ");
+        printJSONString(fens[i]);
+        printf(", ");
+
+        for (int m = 0; m < METRIC_NB; m++) {
+
+            double values[repeats];
+            for (int r = 0; r < repeats; r++)
+                values[r] = samples[METRIC_NB * (i * repeats + r) + m];
+
+            printBenchStats(Metrics[m], values, repeats, m == METRIC_NB - 1 ? "" : ", ");
+        }
+
+        printf("}%s\n", i == count - 1 ? "" : ",");
+    }
+
+    printf("  ],\n");
+    printf("  \"total\": {");
+
+    for (int m = 0; m < SELDEPTH; m++) {
+
+        double values[repeats];
+        for (int r = 0; r < repeats; r++)
+            values[r] = totals[METRIC_NB * r + m];
+
+        printBenchStats(Metrics[m], values, repeats, m == SELDEPTH - 1 ? "" : ", ");
+    }
+
+    printf("}\n}\n");
+
+    for (int i = 0; i < count; i++) free(fens[i]);
+    free(fens); free(samples); free(totals);
+}
+
+void runMicroBenchmark(int iterations) {
+
+    static Board boards[64];
+    static MovePicker mp;
+    uint16_t moves[MAX_MOVES];
+    double start, evalTime, genTime, pickTime;
+    int count, noisy, quiet, size, best;
+
+    volatile int sink = 0; // Keep the evaluations from being optimized out
+    uint64_t evals = 0ull, generated = 0ull, positions = 0ull, picks = 0ull;
+
+    iterations = iterations == 0 ? 40000 : iterations;
+
+    for (count = 0; strcmp(Benchmarks[count], ""); count++)
+        boardFromFEN(&boards[count], Benchmarks[count]);
+
+    // Evaluate without a Pawn King Table, so that every call does all of the
+    // work that a Pawn King Table miss would in the search
+    start = getRealTime();
+    for (int i = 0; i < iterations; i++)
+        for (int j = 0; j < count; j++, evals++)
+            sink += evaluateBoard(&boards[j], NULL);
+    evalTime = getRealTime() - start;
+
+    // Generate the noisy and then quiet moves, as the Move Picker does
+    start = getRealTime();
+    for (int i = 0; i < 10 * iterations; i++) {
+        for (int j = 0; j < count; j++, positions++) {
+            noisy = quiet = 0;
+            genAllNoisyMoves(&boards[j], moves, &noisy);
+            genAllQuietMoves(&boards[j], moves + noisy, &quiet);
+            generated += noisy + quiet;
+        }
+    }
+    genTime = getRealTime() - start;
+
+    // Pull every quiet move out of a picker, best first, as STAGE_QUIET does.
+    // The values are an arbitrary hash of the move, with some repeats, to
+    // stand in for history scores and to exercise ties
+    pickTime = 0;
+    for (int j = 0; j < count; j++) {
+
+        size = 0;
+        genAllQuietMoves(&boards[j], moves, &size);
+
+        start = getRealTime();
+        for (int i = 0; i < iterations; i++) {
+
+            for (int k = 0; k < size; k++) {
+                mp.moves[k]  = moves[k];
+                mp.values[k] = (int)((moves[k] * 2654435761u) >> 20) % 2048 - 1024;
+            }
+
+            for (int end = size; end > 0; end--, picks++) {
+                best = getBestMoveIndex(&mp, 0, end);
+                sink += mp.moves[best];
+                mp.moves[best] = mp.moves[end-1];
+                mp.values[best] = mp.values[end-1];
+            }
+        }
+        pickTime += getRealTime() - start;
+    }
+
+    printf("Evals   : %"PRIu64" in %dms, %d per second\n",
+        evals, (int)evalTime, (int)(evals / (evalTime / 1000.0)));
+    printf("Movegen : %"PRIu64" positions in %dms, %d per second, %d moves per second\n",
+        positions, (int)genTime, (int)(positions / (genTime / 1000.0)),
+        (int)(generated / (genTime / 1000.0)));
+    printf("Picker  : %"PRIu64" picks in %dms, %.2fns per pick\n",
+        picks, (int)pickTime, 1e6 * pickTime / picks);
+}
+
+void runEvalCheck(int playouts) {
+
+    Board board;
+    Undo undo[1];
+    uint16_t moves[MAX_MOVES];
+    char fen[256];
+    int size;
+
+    uint64_t seed = 0x9E3779B97F4A7C15ull, checked = 0ull, failed = 0ull;
+
+    playouts = playouts == 0 ? 200 : playouts;
+
+    // Walk random legal games out of each bench.csv position, comparing the
+    // paired SIMD evaluation with the scalar one at every position reached
+    for (int i = 0; strcmp(Benchmarks[i], ""); i++) {
+        for (int j = 0; j < playouts; j++) {
+
+            boardFromFEN(&board, Benchmarks[i]);
+
+            for (int ply = 0; ply < 128; ply++, checked++) {
+
+                if (!evaluatePairedMatchesScalar(&board) && failed++ < 10) {
+                    boardToFEN(&board, fen);
+                    printf("Mismatch : %s\n", fen);
+                }
+
+                size = 0;
+                genAllLegalMoves(&board, moves, &size);
+                if (size == 0) break;
+
+                seed ^= seed << 13, seed ^= seed >> 7, seed ^= seed << 17;
+                applyMove(&board, moves[seed % size], undo);
+            }
+        }
+    }
+
+    printf("Checked  : %"PRIu64" positions\n", checked);
+    printf("Failed   : %"PRIu64"\n", failed);
+}
@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include <assert.h>
 #include <stdbool.h>
 #include <stdint.h>
 
@@ -54,20 +55,69 @@ enum {
 extern const uint64_t Files[FILE_NB];
 extern const uint64_t Ranks[RANK_NB];
 
-int fileOf(int s);
-int rankOf(int s);
-int relativeRankOf(int c, int s);
-int square(int r, int f);
-
-int popcount(uint64_t b);
-int getlsb(uint64_t b);
-int getmsb(uint64_t b);
-int poplsb(uint64_t *b);
-bool several(uint64_t b);
-bool onlyOne(uint64_t b);
-
-void setBit(uint64_t *b, int i);
-void clearBit(uint64_t *b, int i);
-bool testBit(uint64_t b, int i);
+static inline int fileOf(int s) {
+    assert(0 <= s && s < SQUARE_NB);
+    return s % FILE_NB;
+}
+
+static inline int rankOf(int s) {
+    assert(0 <= s && s < SQUARE_NB);
+    return s / FILE_NB;
+}
+
+static inline int relativeRankOf(int c, int s) {
+    assert(0 <= c && c < COLOUR_NB);
+    assert(0 <= s && s < SQUARE_NB);
+    return c == WHITE ? rankOf(s) : 7 - rankOf(s);
+}
+
+static inline int square(int r, int f) {
+    assert(0 <= r && r < RANK_NB);
+    assert(0 <= f && f < FILE_NB);
+    return r * FILE_NB + f;
+}
+
+static inline int popcount(uint64_t b) {
+    return __builtin_popcountll(b);
+}
+
+static inline int getlsb(uint64_t b) {
+    assert(b);  // lsb(0) is undefined
+    return __builtin_ctzll(b);
+}
+
+static inline int getmsb(uint64_t b) {
+    assert(b);  // msb(0) is undefined
+    return __builtin_clzll(b) ^ 63;
+}
+
+static inline int poplsb(uint64_t *b) {
+    int lsb = getlsb(*b);
+    *b &= *b - 1;
+    return lsb;
+}
+
+static inline bool several(uint64_t b) {
+    return b & (b - 1);
+}
+
+static inline bool onlyOne(uint64_t b) {
+    return b && !several(b);
+}
+
+static inline bool testBit(uint64_t b, int i) {
+    assert(0 <= i && i < SQUARE_NB);
+    return b & (1ull << i);
+}
+
+static inline void setBit(uint64_t *b, int i) {
+    assert(!testBit(*b, i));
+    *b ^= 1ull << i;
+}
+
+static inline void clearBit(uint64_t *b, int i) {
+    assert(testBit(*b, i));
+    *b ^= 1ull << i;
+}
 
 void printBitboard(uint64_t b);
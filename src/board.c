@@ -41,11 +41,6 @@
 
 const char *PieceLabel[COLOUR_NB] = {"PNBRQK", "pnbrqk"};
 
-static const char *Benchmarks[] = {
-    #include "bench.csv"
-    ""
-};
-
 static void clearBoard(Board *board) {
     memset(board, 0, sizeof(*board));
     memset(&board->squares, EMPTY, sizeof(board->squares));
@@ -146,6 +141,11 @@ void boardFromFEN(Board *board, const char *fen) {
     // Move count: ignore and use zero, as we count since root
     board->numMoves = 0;
 
+#ifdef USE_ATTACK_CACHE
+    // Build the attack cache from scratch for the new position
+    initAttackCache(board);
+#endif
+
     // Need king attackers for move generation
     board->kingAttackers = attackersToKingSquare(board);
 
@@ -264,44 +264,6 @@ uint64_t perft(Board *board, int depth){
     return found;
 }
 
-void runBenchmark(Thread *threads, int depth) {
-
-    double start, end;
-    Board board;
-    Limits limits;
-
-    uint64_t nodes = 0ull;
-
-    // Initialize limits for the search
-    limits.limitedByNone  = 0;
-    limits.limitedByTime  = 0;
-    limits.limitedByDepth = 1;
-    limits.limitedBySelf  = 0;
-    limits.timeLimit      = 0;
-    limits.depthLimit     = depth == 0 ? 13 : depth;
-
-    start = getRealTime();
-
-    // Search each benchmark position
-    for (int i = 0; strcmp(Benchmarks[i], ""); i++) {
-        printf("\nPosition #%d: %s\n", i + 1, Benchmarks[i]);
-        boardFromFEN(&board, Benchmarks[i]);
-
-        limits.start = getRealTime();
-        getBestMove(threads, &board, &limits);
-        nodes += nodesSearchedThreadPool(threads);
-
-        clearTT(); // Reset TT for new search
-    }
-
-    end = getRealTime();
-
-    printf("\n------------------------\n");
-    printf("Time  : %dms\n", (int)(end - start));
-    printf("Nodes : %"PRIu64"\n", nodes);
-    printf("NPS   : %d\n", (int)(nodes / ((end - start) / 1000.0)));
-}
-
 int boardIsDrawn(Board *board, int height) {
 
     // Drawn if any of the three possible cases
@@ -373,3 +335,36 @@ int drawnByInsufficientMaterial(Board *board) {
 
     return 0;
 }
+
+int boardHasUpcomingRepetition(Board *board, int height) {
+
+    const uint64_t occupied = board->colours[WHITE] | board->colours[BLACK];
+    const int end = MIN(board->fiftyMoveRule, board->numMoves);
+
+    // Need at least three reversible moves, none of them a null move
+    if (end < 3 || board->history[board->numMoves - 1] == NULL_MOVE)
+        return 0;
+
+    // Look at every position we could reach with one reversible move
+    for (int i = 3; i <= end; i += 2) {
+
+        // Null moves break the chain of reversible moves
+        if (   board->history[board->numMoves - i + 1] == NULL_MOVE
+            || board->history[board->numMoves - i    ] == NULL_MOVE)
+            return 0;
+
+        // The difference must be a single move on an empty board
+        uint64_t diff = board->hash ^ board->history[board->numMoves - i];
+        int slot = cuckooHash1(diff);
+        if (CuckooKeys[slot] != diff && CuckooKeys[(slot = cuckooHash2(diff))] != diff)
+            continue;
+
+        // The move must also be possible on the current board. Only count
+        // cycles which complete after the root, as with drawnByRepetition()
+        uint16_t move = CuckooMoves[slot];
+        if (!(bitsBetweenMasks(MoveFrom(move), MoveTo(move)) & occupied) && i < height)
+            return 1;
+    }
+
+    return 0;
+}
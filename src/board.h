@@ -18,6 +18,8 @@
 
 #pragma once
 
+#include <stddef.h>
+
 #include "types.h"
 
 extern const char *PieceLabel[COLOUR_NB];
@@ -35,10 +37,22 @@ struct Board {
     int fiftyMoveRule;
     int psqtmat;
     int numMoves;
-    uint64_t history[512];
+    NNUEAccumulator *acc; // NULL unless evaluating with the network
+#ifdef USE_ATTACK_CACHE
+    uint64_t attacks[SQUARE_NB];    // Squares attacked by the piece on each square
+    uint64_t attackedBy[COLOUR_NB]; // Union of attacks[] over each colour's pieces
+#endif
+    uint64_t history[512]; // Must remain last, see BOARD_STATE_SIZE
 };
 
+// Every field of the Board aside from the history, which is append only and
+// therefore never needs to be restored when using copy-make (USE_COPY_MAKE)
+#define BOARD_STATE_SIZE (offsetof(Board, history))
+
 struct Undo {
+#ifdef USE_COPY_MAKE
+    uint64_t state[BOARD_STATE_SIZE / sizeof(uint64_t)];
+#else
     uint64_t hash;
     uint64_t pkhash;
     uint64_t kingAttackers;
@@ -46,6 +60,7 @@ struct Undo {
     int epSquare;
     int fiftyMoveRule;
     int psqtmat;
+#endif
     int capturePiece;
 };
 
@@ -56,9 +71,9 @@ void boardToFEN(Board *board, char *fen);
 
 void printBoard(Board *board);
 uint64_t perft(Board *board, int depth);
-void runBenchmark(Thread *threads, int depth);
 
 int boardIsDrawn(Board *board, int height);
 int drawnByFiftyMoveRule(Board *board);
 int drawnByRepetition(Board *board, int height);
 int drawnByInsufficientMaterial(Board *board);
+int boardHasUpcomingRepetition(Board *board, int height);
@@ -0,0 +1,44 @@
+/*
+  Ethereal is a UCI chess playing engine authored by Andrew Grant.
+  <https://github.com/AndyGrant/Ethereal>     <andrew@grantnet.us>
+
+  Ethereal is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Ethereal is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Entry point of the single x86-64 binary built by `make dispatch`. The
+// whole engine is compiled once per ISA level, with main() renamed and every
+// other symbol made local to that copy, so that each copy inlines its own
+// popcount, lsb, slider and SIMD kernels. The copy to run is chosen here,
+// from cpuid, before any of the engine has been initialized
+
+#ifdef USE_DISPATCH
+
+int etherealMainV3(int argc, char **argv); // AVX2, BMI2, POPCNT
+int etherealMainV2(int argc, char **argv); // POPCNT, SSE4.2
+int etherealMainV1(int argc, char **argv); // SSE2
+
+int main(int argc, char **argv) {
+
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("x86-64-v3"))
+        return etherealMainV3(argc, argv);
+
+    if (__builtin_cpu_supports("x86-64-v2"))
+        return etherealMainV2(argc, argv);
+
+    return etherealMainV1(argc, argv);
+}
+
+#endif
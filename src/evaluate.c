@@ -29,10 +29,20 @@
 #include "evaluate.h"
 #include "masks.h"
 #include "movegen.h"
+#include "nnue.h"
 #include "psqt.h"
+#include "thread.h"
 #include "transposition.h"
 #include "types.h"
 
+// The paired evaluation keeps WHITE in the low and BLACK in the high lane of
+// one 128-bit register. It needs the AVX2 per-lane shifts, and is left out of
+// TUNE builds, where the scalar terms are needed to fill in the EvalTrace
+#if defined(__AVX2__) && !defined(TUNE)
+    #define USE_PAIRED_EVAL
+    #include <immintrin.h>
+#endif
+
 #ifdef TUNE
     const int TRACE = 1;
     const EvalTrace EmptyTrace;
@@ -42,6 +52,22 @@
     EvalTrace T;
 #endif
 
+// Each colour dependent evaluate*() term is written once, taking a constant
+// colour, and is then instantiated for both WHITE and BLACK. This lets the
+// compiler fold the shifts, relative ranks and masks picked by colour
+
+#define EVALUATE_BY_COLOUR(name)                                            \
+    static int name##White(EvalInfo *ei, Board *board) {                    \
+        return name##ByColour(ei, board, WHITE);                            \
+    }                                                                       \
+    static int name##Black(EvalInfo *ei, Board *board) {                    \
+        return name##ByColour(ei, board, BLACK);                            \
+    }                                                                       \
+    int name(EvalInfo *ei, Board *board, int colour) {                      \
+        return colour == WHITE ? name##White(ei, board)                     \
+                               : name##Black(ei, board);                    \
+    }
+
 #define S(mg, eg) (MakeScore((mg), (eg)))
 
 /* Material Value Evaluation Terms */
@@ -206,10 +232,39 @@ const int Tempo[COLOUR_NB] = { S(  25,  12), S( -25, -12) };
 
 #undef S
 
+/* Lazy Evaluation Terms */
+
+const int LazyMargin[LAZY_STAGE_NB] = { 640, 600 };
+
+static int evaluatePhase(Board* board){
+
+    // Calcuate the game phase based on remaining material (Fruit Method)
+    int phase = 24 - 4 * popcount(board->pieces[QUEEN ])
+                   - 2 * popcount(board->pieces[ROOK  ])
+                   - 1 * popcount(board->pieces[KNIGHT]
+                                 |board->pieces[BISHOP]);
+
+    return (phase * 256 + 12) / 24;
+}
+
+static int interpolateEval(Board* board, int eval, int phase, int factor){
+
+    // Compute the interpolated and scaled evaluation
+    eval = (ScoreMG(eval) * (256 - phase)
+         +  ScoreEG(eval) * phase * factor / SCALE_NORMAL) / 256;
+
+    // Return the evaluation relative to the side to move
+    return board->turn == WHITE ? eval : -eval;
+}
+
 int evaluateBoard(Board* board, PawnKingTable* pktable){
 
     EvalInfo ei;
-    int phase, factor, eval, pkeval;
+    int eval, pkeval;
+
+    // Defer to the network when this Board is carrying an accumulator
+    if (board->acc != NULL)
+        return nnueEvaluate(board);
 
     // Setup and perform all evaluations
     initializeEvalInfo(&ei, board, pktable);
@@ -217,26 +272,61 @@ int evaluateBoard(Board* board, PawnKingTable* pktable){
     pkeval = ei.pkeval[WHITE] - ei.pkeval[BLACK];
     eval  += pkeval + board->psqtmat + Tempo[board->turn];
 
-    // Calcuate the game phase based on remaining material (Fruit Method)
-    phase = 24 - 4 * popcount(board->pieces[QUEEN ])
-               - 2 * popcount(board->pieces[ROOK  ])
-               - 1 * popcount(board->pieces[KNIGHT]
-                             |board->pieces[BISHOP]);
-    phase = (phase * 256 + 12) / 24;
+    // Store a new Pawn King Entry if we did not have one
+    if (ei.pkentry == NULL && pktable != NULL)
+        storePawnKingEntry(pktable, board->pkhash, ei.passedPawns, pkeval);
+
+    // Scale evaluation based on remaining material and the game phase
+    return interpolateEval(board, eval, evaluatePhase(board), evaluateScaleFactor(board));
+}
 
-    // Scale evaluation based on remaining material
+int evaluateBoardLazy(Thread* thread, Board* board, int alpha, int beta){
+
+    EvalInfo ei;
+    int eval, lazy, phase, factor;
+    PawnKingTable* pktable = &thread->pktable;
+
+    if (board->acc != NULL)
+        return nnueEvaluate(board);
+
+    thread->lazyCalls++;
+
+    // Stage 1. Material, PSQT and a cached Pawn King evaluation. Without a
+    // Pawn King Entry there is nothing to save, as the full evaluation is
+    // then needed anyway in order to store a new entry for later probes
+    initializeEvalInfo(&ei, board, pktable);
+    if (ei.pkentry == NULL)
+        return evaluateBoard(board, pktable);
+
+    phase  = evaluatePhase(board);
     factor = evaluateScaleFactor(board);
 
-    // Compute the interpolated and scaled evaluation
-    eval = (ScoreMG(eval) * (256 - phase)
-         +  ScoreEG(eval) * phase * factor / SCALE_NORMAL) / 256;
+    eval = board->psqtmat + Tempo[board->turn] + ei.pkeval[WHITE];
+    lazy = interpolateEval(board, eval, phase, factor);
 
-    // Store a new Pawn King Entry if we did not have one
-    if (ei.pkentry == NULL && pktable != NULL)
-        storePawnKingEntry(pktable, board->pkhash, ei.passedPawns, pkeval);
+    if (   lazy - LazyMargin[LAZY_MATERIAL] >= beta
+        || lazy + LazyMargin[LAZY_MATERIAL] <= alpha)
+        return thread->lazyExits[LAZY_MATERIAL]++, lazy;
 
-    // Return the evaluation relative to the side to move
-    return board->turn == WHITE ? eval : -eval;
+    // Stage 2. Pawns and the minor and major pieces, leaving King Safety,
+    // Passed Pawns and Threats, which make use of the attacks found here
+    eval += evaluatePawns  (&ei, board, WHITE) - evaluatePawns  (&ei, board, BLACK);
+    eval += evaluateKnights(&ei, board, WHITE) - evaluateKnights(&ei, board, BLACK);
+    eval += evaluateBishops(&ei, board, WHITE) - evaluateBishops(&ei, board, BLACK);
+    eval += evaluateRooks  (&ei, board, WHITE) - evaluateRooks  (&ei, board, BLACK);
+    eval += evaluateQueens (&ei, board, WHITE) - evaluateQueens (&ei, board, BLACK);
+    lazy  = interpolateEval(board, eval, phase, factor);
+
+    if (   lazy - LazyMargin[LAZY_PIECES] >= beta
+        || lazy + LazyMargin[LAZY_PIECES] <= alpha)
+        return thread->lazyExits[LAZY_PIECES]++, lazy;
+
+    // Stage 3. Everything else, arriving at the same score as evaluateBoard()
+    eval += evaluateKings      (&ei, board, WHITE) - evaluateKings      (&ei, board, BLACK);
+    eval += evaluatePassedPawns(&ei, board, WHITE) - evaluatePassedPawns(&ei, board, BLACK);
+    eval += evaluateAllThreats(&ei, board);
+
+    return interpolateEval(board, eval, phase, factor);
 }
 
 int evaluatePieces(EvalInfo *ei, Board *board) {
@@ -264,13 +354,13 @@ int evaluatePieces(EvalInfo *ei, Board *board) {
     eval += evaluatePassedPawns(ei, board, WHITE)
           - evaluatePassedPawns(ei, board, BLACK);
 
-    eval += evaluateThreats(ei, board, WHITE)
-          - evaluateThreats(ei, board, BLACK);
+    eval += evaluateAllThreats(ei, board);
 
     return eval;
 }
 
-int evaluatePawns(EvalInfo *ei, Board *board, int colour) {
+static inline __attribute__((always_inline))
+int evaluatePawnsByColour(EvalInfo *ei, Board *board, const int colour) {
 
     const int US = colour, THEM = !colour;
     const int Forward = (colour == WHITE) ? 8 : -8;
@@ -338,7 +428,10 @@ int evaluatePawns(EvalInfo *ei, Board *board, int colour) {
     return eval;
 }
 
-int evaluateKnights(EvalInfo *ei, Board *board, int colour) {
+EVALUATE_BY_COLOUR(evaluatePawns)
+
+static inline __attribute__((always_inline))
+int evaluateKnightsByColour(EvalInfo *ei, Board *board, const int colour) {
 
     const int US = colour, THEM = !colour;
 
@@ -397,7 +490,10 @@ int evaluateKnights(EvalInfo *ei, Board *board, int colour) {
     return eval;
 }
 
-int evaluateBishops(EvalInfo *ei, Board *board, int colour) {
+EVALUATE_BY_COLOUR(evaluateKnights)
+
+static inline __attribute__((always_inline))
+int evaluateBishopsByColour(EvalInfo *ei, Board *board, const int colour) {
 
     const int US = colour, THEM = !colour;
 
@@ -468,7 +564,10 @@ int evaluateBishops(EvalInfo *ei, Board *board, int colour) {
     return eval;
 }
 
-int evaluateRooks(EvalInfo *ei, Board *board, int colour) {
+EVALUATE_BY_COLOUR(evaluateBishops)
+
+static inline __attribute__((always_inline))
+int evaluateRooksByColour(EvalInfo *ei, Board *board, const int colour) {
 
     const int US = colour, THEM = !colour;
 
@@ -528,7 +627,10 @@ int evaluateRooks(EvalInfo *ei, Board *board, int colour) {
     return eval;
 }
 
-int evaluateQueens(EvalInfo *ei, Board *board, int colour) {
+EVALUATE_BY_COLOUR(evaluateRooks)
+
+static inline __attribute__((always_inline))
+int evaluateQueensByColour(EvalInfo *ei, Board *board, const int colour) {
 
     const int US = colour, THEM = !colour;
 
@@ -571,7 +673,10 @@ int evaluateQueens(EvalInfo *ei, Board *board, int colour) {
     return eval;
 }
 
-int evaluateKings(EvalInfo *ei, Board *board, int colour) {
+EVALUATE_BY_COLOUR(evaluateQueens)
+
+static inline __attribute__((always_inline))
+int evaluateKingsByColour(EvalInfo *ei, Board *board, const int colour) {
 
     const int US = colour, THEM = !colour;
 
@@ -672,7 +777,10 @@ int evaluateKings(EvalInfo *ei, Board *board, int colour) {
     return eval;
 }
 
-int evaluatePassedPawns(EvalInfo* ei, Board* board, int colour){
+EVALUATE_BY_COLOUR(evaluateKings)
+
+static inline __attribute__((always_inline))
+int evaluatePassedPawnsByColour(EvalInfo *ei, Board *board, const int colour) {
 
     const int US = colour, THEM = !colour;
 
@@ -716,7 +824,10 @@ int evaluatePassedPawns(EvalInfo* ei, Board* board, int colour){
     return eval;
 }
 
-int evaluateThreats(EvalInfo *ei, Board *board, int colour) {
+EVALUATE_BY_COLOUR(evaluatePassedPawns)
+
+static inline __attribute__((always_inline))
+int evaluateThreatsByColour(EvalInfo *ei, Board *board, const int colour) {
 
     const int US = colour, THEM = !colour;
     const uint64_t Rank3Rel = US == WHITE ? RANK_3 : RANK_6;
@@ -792,6 +903,8 @@ int evaluateThreats(EvalInfo *ei, Board *board, int colour) {
     return eval;
 }
 
+EVALUATE_BY_COLOUR(evaluateThreats)
+
 int evaluateScaleFactor(Board *board) {
 
     uint64_t white   = board->colours[WHITE];
@@ -829,7 +942,7 @@ int evaluateScaleFactor(Board *board) {
     return SCALE_NORMAL;
 }
 
-void initializeEvalInfo(EvalInfo* ei, Board* board, PawnKingTable* pktable){
+static void initializeEvalInfoScalar(EvalInfo* ei, Board* board, PawnKingTable* pktable){
 
     uint64_t white   = board->colours[WHITE];
     uint64_t black   = board->colours[BLACK];
@@ -878,3 +991,213 @@ void initializeEvalInfo(EvalInfo* ei, Board* board, PawnKingTable* pktable){
     ei->pkeval[WHITE] = ei->pkentry == NULL ? 0    : ei->pkentry->eval;
     ei->pkeval[BLACK] = ei->pkentry == NULL ? 0    : 0;
 }
+
+#ifdef USE_PAIRED_EVAL
+
+typedef __m128i Pair; // { WHITE, BLACK } bitboards
+
+static inline Pair pairLoad(const uint64_t bb[COLOUR_NB]) {
+    return _mm_loadu_si128((const __m128i*) bb);
+}
+
+static inline void pairStore(uint64_t bb[COLOUR_NB], Pair p) {
+    _mm_storeu_si128((__m128i*) bb, p);
+}
+
+static inline Pair pairMake(uint64_t white, uint64_t black) {
+    return _mm_set_epi64x(black, white);
+}
+
+static inline Pair pairSplat(uint64_t bb) {
+    return _mm_set1_epi64x(bb);
+}
+
+static inline Pair pairSwap(Pair p) {
+    return _mm_shuffle_epi32(p, _MM_SHUFFLE(1, 0, 3, 2));
+}
+
+static inline Pair pairAnd(Pair a, Pair b) { return _mm_and_si128(a, b); }
+static inline Pair pairOr (Pair a, Pair b) { return _mm_or_si128(a, b);  }
+static inline Pair pairXor(Pair a, Pair b) { return _mm_xor_si128(a, b); }
+static inline Pair pairAndNot(Pair a, Pair b) { return _mm_andnot_si128(b, a); } // a & ~b
+
+static inline Pair pairForward(Pair p, int n) {
+    // Shift each lane towards the enemy, a shift of 64 clears the other lane
+    return _mm_or_si128(_mm_sllv_epi64(p, _mm_set_epi64x(64, n)),
+                        _mm_srlv_epi64(p, _mm_set_epi64x(n, 64)));
+}
+
+static inline Pair pairBackward(Pair p, int n) {
+    return _mm_or_si128(_mm_srlv_epi64(p, _mm_set_epi64x(64, n)),
+                        _mm_sllv_epi64(p, _mm_set_epi64x(n, 64)));
+}
+
+static inline Pair pairAdvance(Pair pawns, Pair occupied) {
+    return pairAndNot(pairForward(pawns, 8), occupied);
+}
+
+static inline Pair pairAttackSpan(Pair pawns, Pair targets) {
+    Pair left  = pairAnd(pairForward(pawns, 7), pairMake(~FILE_H, ~FILE_A));
+    Pair right = pairAnd(pairForward(pawns, 9), pairMake(~FILE_A, ~FILE_H));
+    return pairAnd(pairOr(left, right), targets);
+}
+
+static inline int pairCountDiff(Pair p) {
+    return popcount(_mm_cvtsi128_si64(p)) - popcount(_mm_extract_epi64(p, 1));
+}
+
+static void initializeEvalInfoPaired(EvalInfo* ei, Board* board, PawnKingTable* pktable){
+
+    const uint64_t kings = board->pieces[KING];
+
+    const int wKingSq = ei->kingSquare[WHITE] = getlsb(board->colours[WHITE] & kings);
+    const int bKingSq = ei->kingSquare[BLACK] = getlsb(board->colours[BLACK] & kings);
+
+    const Pair us       = pairLoad(board->colours);
+    const Pair occupied = pairSplat(board->colours[WHITE] | board->colours[BLACK]);
+    const Pair pawns    = pairAnd(us, pairSplat(board->pieces[PAWN]));
+    const Pair kingAtks = pairMake(kingAttacks(wKingSq), kingAttacks(bKingSq));
+
+    const Pair pawnAttacks  = pairAttackSpan(pawns, pairSplat(~0ull));
+    const Pair blockedPawns = pairAnd(pawns, pairBackward(occupied, 8));
+
+    pairStore(ei->pawnAttacks,  pawnAttacks);
+    pairStore(ei->rammedPawns,  pairAnd(pawns, pairBackward(pairSwap(pawns), 8)));
+    pairStore(ei->blockedPawns, blockedPawns);
+
+    pairStore(ei->kingAreas, pairOr(pairOr(kingAtks, pairForward(kingAtks, 8)),
+                                    pairMake(1ull << wKingSq, 1ull << bKingSq)));
+
+    pairStore(ei->mobilityAreas, pairXor(pairOr(pairOr(pairSwap(pawnAttacks), blockedPawns),
+                                                pairAnd(us, pairSplat(kings))), pairSplat(~0ull)));
+
+    pairStore(ei->attacked, kingAtks);
+    ei->attackedBy[WHITE][KING] = ei->attacked[WHITE];
+    ei->attackedBy[BLACK][KING] = ei->attacked[BLACK];
+
+    pairStore(ei->occupiedMinusBishops, pairXor(occupied, pairAnd(us,
+        pairSplat(board->pieces[BISHOP] | board->pieces[QUEEN]))));
+
+    pairStore(ei->occupiedMinusRooks, pairXor(occupied, pairAnd(us,
+        pairSplat(board->pieces[ROOK] | board->pieces[QUEEN]))));
+
+    ei->kingAttacksCount[WHITE]    = ei->kingAttacksCount[BLACK]    = 0;
+    ei->kingAttackersCount[WHITE]  = ei->kingAttackersCount[BLACK]  = 0;
+    ei->kingAttackersWeight[WHITE] = ei->kingAttackersWeight[BLACK] = 0;
+
+    ei->pkentry       =     pktable == NULL ? NULL : getPawnKingEntry(pktable, board->pkhash);
+    ei->passedPawns   = ei->pkentry == NULL ? 0ull : ei->pkentry->passed;
+    ei->pkeval[WHITE] = ei->pkentry == NULL ? 0    : ei->pkentry->eval;
+    ei->pkeval[BLACK] = ei->pkentry == NULL ? 0    : 0;
+}
+
+static int evaluateThreatsPaired(EvalInfo *ei, Board *board) {
+
+    // Mirrors evaluateThreats(), with the low lane holding the terms for
+    // WHITE as US and the high lane the terms for BLACK as US
+
+    int eval = 0;
+
+    const Pair us       = pairLoad(board->colours);
+    const Pair them     = pairSwap(us);
+    const Pair occupied = pairSplat(board->colours[WHITE] | board->colours[BLACK]);
+
+    const Pair pawns   = pairAnd(us, pairSplat(board->pieces[PAWN  ]));
+    const Pair minors  = pairAnd(us, pairSplat(board->pieces[KNIGHT] | board->pieces[BISHOP]));
+    const Pair rooks   = pairAnd(us, pairSplat(board->pieces[ROOK  ]));
+    const Pair queens  = pairAnd(us, pairSplat(board->pieces[QUEEN ]));
+
+    const Pair byPawns  = pairMake(ei->attackedBy[WHITE][PAWN], ei->attackedBy[BLACK][PAWN]);
+    const Pair byMinors = pairMake(ei->attackedBy[WHITE][KNIGHT] | ei->attackedBy[WHITE][BISHOP],
+                                   ei->attackedBy[BLACK][KNIGHT] | ei->attackedBy[BLACK][BISHOP]);
+    const Pair byMajors = pairMake(ei->attackedBy[WHITE][ROOK] | ei->attackedBy[WHITE][QUEEN],
+                                   ei->attackedBy[BLACK][ROOK] | ei->attackedBy[BLACK][QUEEN]);
+
+    const Pair attacksByPawns  = pairSwap(byPawns);
+    const Pair attacksByMinors = pairSwap(byMinors);
+    const Pair attacksByMajors = pairSwap(byMajors);
+
+    const Pair attacked    = pairLoad(ei->attacked);
+    const Pair attackedBy2 = pairLoad(ei->attackedBy2);
+    const Pair theirAttacked    = pairSwap(attacked);
+    const Pair theirAttackedBy2 = pairSwap(attackedBy2);
+
+    // Squares with more attackers, few defenders, and no pawn support
+    const Pair poorlyDefended = pairOr(pairAndNot(theirAttacked, attacked),
+        pairAndNot(pairAndNot(theirAttackedBy2, attackedBy2), byPawns));
+
+    // A friendly minor / major is overloaded if attacked and defended by exactly one
+    const Pair overloaded = pairAnd(pairAnd(pairOr(minors, pairOr(rooks, queens)),
+                                            pairAndNot(attacked, attackedBy2)),
+                                    pairAndNot(theirAttacked, theirAttackedBy2));
+
+    // Safe pawn pushes which would threaten an enemy non-pawn piece
+    Pair pushThreat = pairAdvance(pawns, occupied);
+    pushThreat = pairOr(pushThreat, pairAdvance(pairAnd(pairAndNot(pushThreat, attacksByPawns),
+                                                        pairMake(RANK_3, RANK_6)), occupied));
+    pushThreat = pairAnd(pairAndNot(pushThreat, attacksByPawns),
+                         pairOr(attacked, pairXor(theirAttacked, pairSplat(~0ull))));
+    pushThreat = pairAttackSpan(pushThreat, pairAndNot(them, byPawns));
+
+    eval += ThreatWeakPawn             * pairCountDiff(pairAnd(pairAndNot(pawns, attacksByPawns), poorlyDefended));
+    eval += ThreatMinorAttackedByPawn  * pairCountDiff(pairAnd(minors, attacksByPawns));
+    eval += ThreatMinorAttackedByMajor * pairCountDiff(pairAnd(pairAnd(minors, poorlyDefended), attacksByMajors));
+    eval += ThreatRookAttackedByLesser * pairCountDiff(pairAnd(rooks, pairOr(attacksByPawns, attacksByMinors)));
+    eval += ThreatQueenAttackedByOne   * pairCountDiff(pairAnd(queens, theirAttacked));
+    eval += ThreatOverloadedPieces     * pairCountDiff(overloaded);
+    eval += ThreatByPawnPush           * pairCountDiff(pushThreat);
+
+    return eval;
+}
+
+#endif
+
+void initializeEvalInfo(EvalInfo* ei, Board* board, PawnKingTable* pktable){
+#ifdef USE_PAIRED_EVAL
+    initializeEvalInfoPaired(ei, board, pktable);
+#else
+    initializeEvalInfoScalar(ei, board, pktable);
+#endif
+}
+
+int evaluateAllThreats(EvalInfo *ei, Board *board) {
+#ifdef USE_PAIRED_EVAL
+    return evaluateThreatsPaired(ei, board);
+#else
+    return evaluateThreats(ei, board, WHITE)
+         - evaluateThreats(ei, board, BLACK);
+#endif
+}
+
+int evaluatePairedMatchesScalar(Board *board) {
+
+#ifdef USE_PAIRED_EVAL
+
+    EvalInfo paired, scalar;
+
+    // Compare every field set up by the initialization, then run the scalar
+    // terms once so that both threat evaluations see the same attack maps
+    initializeEvalInfoPaired(&paired, board, NULL);
+    initializeEvalInfoScalar(&scalar, board, NULL);
+
+    #define SAME(field) (!memcmp(&paired.field, &scalar.field, sizeof(scalar.field)))
+
+    if (   !SAME(pawnAttacks) || !SAME(rammedPawns)  || !SAME(blockedPawns)
+        || !SAME(kingAreas)   || !SAME(mobilityAreas) || !SAME(attacked)
+        || !SAME(occupiedMinusBishops) || !SAME(occupiedMinusRooks)
+        || !SAME(kingSquare)  || paired.attackedBy[WHITE][KING] != scalar.attackedBy[WHITE][KING]
+        || paired.attackedBy[BLACK][KING] != scalar.attackedBy[BLACK][KING])
+        return 0;
+
+    #undef SAME
+
+    evaluatePieces(&scalar, board);
+
+    return evaluateThreatsPaired(&scalar, board)
+        == evaluateThreats(&scalar, board, WHITE) - evaluateThreats(&scalar, board, BLACK);
+
+#else
+    (void)board; // Silence compiler warnings (unused variable)
+    return 1;
+#endif
+}
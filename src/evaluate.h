@@ -30,6 +30,12 @@ enum {
     SCALE_NORMAL           = 128,
 };
 
+enum {
+    LAZY_MATERIAL,
+    LAZY_PIECES,
+    LAZY_STAGE_NB,
+};
+
 struct EvalTrace {
     int PawnValue[COLOUR_NB];
     int KnightValue[COLOUR_NB];
@@ -95,6 +101,7 @@ struct EvalInfo {
 };
 
 int evaluateBoard(Board *board, PawnKingTable *pktable);
+int evaluateBoardLazy(Thread *thread, Board *board, int alpha, int beta);
 int evaluatePieces(EvalInfo *ei, Board *board);
 int evaluatePawns(EvalInfo *ei, Board *board, int colour);
 int evaluateKnights(EvalInfo *ei, Board *board, int colour);
@@ -104,8 +111,10 @@ int evaluateQueens(EvalInfo *ei, Board *board, int colour);
 int evaluateKings(EvalInfo *ei, Board *board, int colour);
 int evaluatePassedPawns(EvalInfo *ei, Board *board, int colour);
 int evaluateThreats(EvalInfo *ei, Board *board, int colour);
+int evaluateAllThreats(EvalInfo *ei, Board *board);
 int evaluateScaleFactor(Board *board);
 void initializeEvalInfo(EvalInfo *ei, Board *board, PawnKingTable *pktable);
+int evaluatePairedMatchesScalar(Board *board);
 
 #define MakeScore(mg, eg) ((int)((unsigned int)(eg) << 16) + (mg))
 
@@ -156,6 +156,50 @@ void updateFUHistory(Thread *thread, int height, uint16_t move, int delta) {
     thread->fuhistory[piece1][to1][piece2][to2] = entry;
 }
 
+int getCaptureHistoryScore(Thread *thread, uint16_t move) {
+
+    int to, piece, captured;
+
+    to       = MoveTo(move);
+    piece    = pieceType(thread->board.squares[MoveFrom(move)]);
+    captured = MoveType(move) == ENPASS_MOVE ? PAWN
+             : pieceType(thread->board.squares[to]);
+
+    // Promotions without a capture have no entry
+    if (captured == PIECE_NB)
+        return 0;
+
+    assert(0 <= piece && piece < PIECE_NB);
+    assert(0 <= to && to < SQUARE_NB);
+    assert(0 <= captured && captured < PIECE_NB);
+
+    return thread->chistory[piece][to][captured];
+}
+
+void updateCaptureHistory(Thread *thread, uint16_t move, int delta) {
+
+    int entry, to, piece, captured;
+
+    to       = MoveTo(move);
+    piece    = pieceType(thread->board.squares[MoveFrom(move)]);
+    captured = MoveType(move) == ENPASS_MOVE ? PAWN
+             : pieceType(thread->board.squares[to]);
+
+    // Promotions without a capture have no entry
+    if (captured == PIECE_NB)
+        return;
+
+    assert(0 <= piece && piece < PIECE_NB);
+    assert(0 <= to && to < SQUARE_NB);
+    assert(0 <= captured && captured < PIECE_NB);
+
+    delta = MAX(-400, MIN(400, delta));
+
+    entry = thread->chistory[piece][to][captured];
+    entry += 32 * delta - entry * abs(delta) / 512;
+    thread->chistory[piece][to][captured] = entry;
+}
+
 uint16_t getCounterMove(Thread *thread, int height) {
 
     int colour, to, piece;
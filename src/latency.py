@@ -0,0 +1,104 @@
+# Ethereal is a UCI chess playing engine authored by Andrew Grant.
+# <https://github.com/AndyGrant/Ethereal>     <andrew@grantnet.us>
+#
+# Ethereal is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# Ethereal is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+# Measures how long Ethereal takes to answer commands while it is searching.
+# Each command is sent during a running "go infinite" or "go ponder" search,
+# and the time until the expected reply is reported. A reply which takes
+# longer than TIMEOUT seconds is counted as a timeout, and any timeout makes
+# the script exit with a failure, so that it can serve as a regression test.
+#
+# Usage: python3 latency.py ENGINE [ROUNDS] [THREADS]
+
+import queue
+import subprocess
+import sys
+import threading
+import time
+
+ENGINE  = sys.argv[1]
+ROUNDS  = int(sys.argv[2]) if len(sys.argv) > 2 else 20
+THREADS = int(sys.argv[3]) if len(sys.argv) > 3 else 1
+TIMEOUT = 5.0
+
+process = subprocess.Popen(
+    ENGINE, stdin=subprocess.PIPE, stdout=subprocess.PIPE, universal_newlines=True)
+
+# Read the engine's output on a thread, so that waiting can time out
+lines = queue.Queue()
+threading.Thread(target=lambda: [lines.put(line) for line in process.stdout], daemon=True).start()
+
+def send(command):
+    process.stdin.write(command + "\n")
+    process.stdin.flush()
+
+def wait(prefix, timeout=TIMEOUT):
+    deadline = time.time() + timeout
+    while time.time() < deadline:
+        try: line = lines.get(timeout=deadline - time.time())
+        except queue.Empty: break
+        if line.startswith(prefix): return True
+    return False
+
+def measure(command, prefix):
+    start = time.time()
+    send(command)
+    return 1000 * (time.time() - start) if wait(prefix) else None
+
+send("uci"); wait("uciok")
+send("setoption name Threads value %d" % THREADS)
+send("isready"); wait("readyok")
+
+results = { name : [] for name in ("isready", "setoption", "stop", "ponderhit + stop", "go + isready") }
+
+for round in range(ROUNDS):
+
+    send("position startpos moves e2e4 e7e5")
+
+    # While searching, isready and setoption are answered and stop ends it
+    send("go infinite"); time.sleep(0.2)
+    results["isready"].append(measure("isready", "readyok"))
+    results["setoption"].append(measure("setoption name MoveOverhead value 100", "info string set"))
+    results["stop"].append(measure("stop", "bestmove"))
+
+    # A ponderhit turns a ponder search into a timed one, which we then stop
+    send("go ponder wtime 60000 btime 60000"); time.sleep(0.2)
+    send("ponderhit"); time.sleep(0.1)
+    results["ponderhit + stop"].append(measure("stop", "bestmove"))
+
+    # Sent in a single write, the go is often still queued when the isready
+    # arrives, which must not leave the isready waiting on the search
+    results["go + isready"].append(measure("position startpos\ngo infinite\nisready", "readyok"))
+    send("stop")
+
+    # Wait out anything left over before the next round
+    send("isready"); wait("readyok", 60)
+
+send("quit")
+
+print("%-18s %8s %8s %8s %8s" % ("Command", "Min ms", "Median", "Max ms", "Timeouts"))
+
+timeouts = 0
+
+for name, times in results.items():
+    answered = sorted(t for t in times if t is not None)
+    timeouts += len(times) - len(answered)
+    if not answered:
+        print("%-18s %8s %8s %8s %8d" % (name, "-", "-", "-", len(times)))
+        continue
+    print("%-18s %8.2f %8.2f %8.2f %8d" % (name, answered[0],
+        answered[len(answered) // 2], answered[-1], len(times) - len(answered)))
+
+sys.exit(1 if timeouts else 0)
@@ -19,6 +19,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
+#include <string.h>
 #include <assert.h>
 
 #include "bitboards.h"
@@ -28,10 +29,36 @@
 #include "masks.h"
 #include "move.h"
 #include "movegen.h"
+#include "nnue.h"
 #include "psqt.h"
 #include "types.h"
 #include "zobrist.h"
 
+#ifdef USE_ATTACK_CACHE
+
+static uint64_t moveChangedSquares(uint16_t move) {
+
+    // Every square whose occupancy is modified by the move. Castling also
+    // moves the rook, and an enpass capture removes the pawn behind the
+    // destination, which always sits on the same file one rank away
+
+    const int to = MoveTo(move);
+    const int from = MoveFrom(move);
+
+    uint64_t changed = (1ull << from) | (1ull << to);
+
+    if (MoveType(move) == CASTLE_MOVE)
+        changed |= (1ull << castleGetRookFrom(from, to))
+                |  (1ull << castleGetRookTo(from, to));
+
+    if (MoveType(move) == ENPASS_MOVE)
+        changed |= (1ull << (to ^ 8));
+
+    return changed;
+}
+
+#endif
+
 void applyMove(Board *board, uint16_t move, Undo *undo) {
 
     static void (*table[4])(Board*, uint16_t, Undo*) = {
@@ -39,6 +66,12 @@ void applyMove(Board *board, uint16_t move, Undo *undo) {
         applyEnpassMove, applyPromotionMove
     };
 
+    const int epSquare = board->epSquare;
+
+#ifdef USE_COPY_MAKE
+    // Snapshot the entire Board, so that revertMove() is a single copy
+    memcpy(undo->state, board, BOARD_STATE_SIZE);
+#else
     undo->hash = board->hash;
     undo->pkhash = board->pkhash;
     undo->kingAttackers = board->kingAttackers;
@@ -46,6 +79,7 @@ void applyMove(Board *board, uint16_t move, Undo *undo) {
     undo->epSquare = board->epSquare;
     undo->fiftyMoveRule = board->fiftyMoveRule;
     undo->psqtmat = board->psqtmat;
+#endif
 
     // Store hash history for three-fold checking
     board->history[board->numMoves++] = board->hash;
@@ -61,8 +95,16 @@ void applyMove(Board *board, uint16_t move, Undo *undo) {
     // Run the correct move function
     table[MoveType(move) >> 12](board, move, undo);
 
+    // Push an updated accumulator when evaluating with the network
+    if (board->acc != NULL) nnueUpdate(board, move, undo->capturePiece);
+
+#ifdef USE_ATTACK_CACHE
+    // Refresh the attacks of every piece which the move could have affected
+    updateAttackCache(board, moveChangedSquares(move));
+#endif
+
     // No function updated epsquare, so we reset
-    if (board->epSquare == undo->epSquare) board->epSquare = -1;
+    if (board->epSquare == epSquare) board->epSquare = -1;
 
     // No function updates this, so we do it here
     board->turn = !board->turn;
@@ -256,9 +298,13 @@ void applyPromotionMove(Board *board, uint16_t move, Undo *undo) {
 
 void applyNullMove(Board *board, Undo *undo) {
 
+#ifdef USE_COPY_MAKE
+    memcpy(undo->state, board, BOARD_STATE_SIZE);
+#else
     undo->hash = board->hash;
     undo->epSquare = board->epSquare;
     undo->fiftyMoveRule = board->fiftyMoveRule;
+#endif
 
     board->turn = !board->turn;
     board->history[board->numMoves++] = NULL_MOVE;
@@ -271,6 +317,19 @@ void applyNullMove(Board *board, Undo *undo) {
     board->fiftyMoveRule += 1;
 }
 
+#ifdef USE_COPY_MAKE
+
+void revertMove(Board *board, uint16_t move, Undo *undo) {
+    (void)move; // Silence compiler warnings (unused variable)
+    memcpy(board, undo->state, BOARD_STATE_SIZE);
+}
+
+void revertNullMove(Board *board, Undo *undo) {
+    memcpy(board, undo->state, BOARD_STATE_SIZE);
+}
+
+#else
+
 void revertMove(Board *board, uint16_t move, Undo *undo) {
 
     const int to = MoveTo(move);
@@ -278,6 +337,7 @@ void revertMove(Board *board, uint16_t move, Undo *undo) {
 
     board->turn = !board->turn;
     board->numMoves--;
+    if (board->acc != NULL) board->acc--;
     board->hash = undo->hash;
     board->pkhash = undo->pkhash;
     board->kingAttackers = undo->kingAttackers;
@@ -353,6 +413,10 @@ void revertMove(Board *board, uint16_t move, Undo *undo) {
         board->squares[to] = EMPTY;
         board->squares[ep] = undo->capturePiece;
     }
+
+#ifdef USE_ATTACK_CACHE
+    updateAttackCache(board, moveChangedSquares(move));
+#endif
 }
 
 void revertNullMove(Board *board, Undo *undo) {
@@ -364,6 +428,8 @@ void revertNullMove(Board *board, Undo *undo) {
     board->numMoves--;
 }
 
+#endif
+
 void moveToString(uint16_t move, char *str) {
 
     squareToString(MoveFrom(move), &str[0]);
@@ -144,11 +144,28 @@ void genAllMoves(Board* board, uint16_t* moves, int* size){
     *size = noisy + quiet;
 }
 
-void genAllNoisyMoves(Board* board, uint16_t* moves, int* size){
+// Noisy and quiet generation is written once, taking the side to move as a
+// constant, and then instantiated for both WHITE and BLACK, so that pawn
+// shifts, relative ranks and castling squares are folded into constants
+
+#define GENERATE_BY_COLOUR(name, generator)                                 \
+    static void name##White(Board* board, uint16_t* moves, int* size){      \
+        generator(board, moves, size, WHITE);                               \
+    }                                                                       \
+    static void name##Black(Board* board, uint16_t* moves, int* size){      \
+        generator(board, moves, size, BLACK);                               \
+    }                                                                       \
+    void name(Board* board, uint16_t* moves, int* size){                    \
+        if (board->turn == WHITE) name##White(board, moves, size);          \
+        else                      name##Black(board, moves, size);          \
+    }
+
+static inline __attribute__((always_inline))
+void genNoisyMovesByColour(Board* board, uint16_t* moves, int* size, const int US){
 
-    const int forwardShift = board->turn == WHITE ? -8 : 8;
-    const int leftShift    = board->turn == WHITE ? -7 : 7;
-    const int rightShift   = board->turn == WHITE ? -9 : 9;
+    const int forwardShift = US == WHITE ? -8 : 8;
+    const int leftShift    = US == WHITE ? -7 : 7;
+    const int rightShift   = US == WHITE ? -9 : 9;
 
     uint64_t destinations;
     uint64_t pawnEnpass;
@@ -158,8 +175,8 @@ void genAllNoisyMoves(Board* board, uint16_t* moves, int* size){
     uint64_t pawnPromoLeft;
     uint64_t pawnPromoRight;
 
-    uint64_t friendly = board->colours[board->turn];
-    uint64_t enemy    = board->colours[!board->turn];
+    uint64_t friendly = board->colours[US];
+    uint64_t enemy    = board->colours[!US];
 
     uint64_t empty    = ~(friendly | enemy);
     uint64_t occupied = ~empty;
@@ -191,10 +208,10 @@ void genAllNoisyMoves(Board* board, uint16_t* moves, int* size){
         destinations = enemy;
 
     // Compute bitboards for each type of pawn movement
-    pawnEnpass       = pawnEnpassCaptures(myPawns, board->epSquare, board->turn);
-    pawnLeft         = pawnLeftAttacks(myPawns, enemy, board->turn);
-    pawnRight        = pawnRightAttacks(myPawns, enemy, board->turn);
-    pawnPromoForward = pawnAdvance(myPawns, occupied, board->turn) & PROMOTION_RANKS;
+    pawnEnpass       = pawnEnpassCaptures(myPawns, board->epSquare, US);
+    pawnLeft         = pawnLeftAttacks(myPawns, enemy, US);
+    pawnRight        = pawnRightAttacks(myPawns, enemy, US);
+    pawnPromoForward = pawnAdvance(myPawns, occupied, US) & PROMOTION_RANKS;
     pawnPromoLeft    = pawnLeft & PROMOTION_RANKS; pawnLeft &= ~PROMOTION_RANKS;
     pawnPromoRight   = pawnRight & PROMOTION_RANKS; pawnRight &= ~PROMOTION_RANKS;
 
@@ -217,18 +234,21 @@ void genAllNoisyMoves(Board* board, uint16_t* moves, int* size){
     buildKingMoves(moves, size, myKings, enemy);
 }
 
-void genAllQuietMoves(Board* board, uint16_t* moves, int* size){
+GENERATE_BY_COLOUR(genAllNoisyMoves, genNoisyMovesByColour)
+
+static inline __attribute__((always_inline))
+void genQuietMovesByColour(Board* board, uint16_t* moves, int* size, const int US){
 
-    const uint64_t rank3Rel = board->turn == WHITE ? RANK_3 : RANK_6;
-    const int forwardShift  = board->turn == WHITE ?     -8 :      8;
+    const uint64_t rank3Rel = US == WHITE ? RANK_3 : RANK_6;
+    const int forwardShift  = US == WHITE ?     -8 :      8;
 
     uint64_t destinations;
 
     uint64_t pawnForwardOne;
     uint64_t pawnForwardTwo;
 
-    uint64_t friendly = board->colours[board->turn];
-    uint64_t enemy = board->colours[!board->turn];
+    uint64_t friendly = board->colours[US];
+    uint64_t enemy = board->colours[!US];
 
     uint64_t empty    = ~(friendly | enemy);
     uint64_t occupied = ~empty;
@@ -270,8 +290,8 @@ void genAllQuietMoves(Board* board, uint16_t* moves, int* size){
         destinations = empty;
 
     // Compute bitboards for the pawn advances
-    pawnForwardOne = pawnAdvance(myPawns, occupied, board->turn) & ~PROMOTION_RANKS;
-    pawnForwardTwo = pawnAdvance(pawnForwardOne & rank3Rel, occupied, board->turn);
+    pawnForwardOne = pawnAdvance(myPawns, occupied, US) & ~PROMOTION_RANKS;
+    pawnForwardTwo = pawnAdvance(pawnForwardOne & rank3Rel, occupied, US);
 
     // Generate all of the pawn advances
     buildPawnMoves(moves, size, pawnForwardOne & destinations, forwardShift);
@@ -284,7 +304,7 @@ void genAllQuietMoves(Board* board, uint16_t* moves, int* size){
     buildKingMoves(moves, size, myKings, empty);
 
     // Generate all the castling moves
-    if (board->turn == WHITE && !board->kingAttackers){
+    if (US == WHITE && !board->kingAttackers){
 
         if (  ((occupied & WHITE_CASTLE_KING_SIDE_MAP) == 0)
             && (board->castleRights & WHITE_KING_RIGHTS)
@@ -297,7 +317,7 @@ void genAllQuietMoves(Board* board, uint16_t* moves, int* size){
             moves[(*size)++] = MoveMake(4, 2, CASTLE_MOVE);
     }
 
-    else if (board->turn == BLACK && !board->kingAttackers) {
+    else if (US == BLACK && !board->kingAttackers) {
 
         if (  ((occupied & BLACK_CASTLE_KING_SIDE_MAP) == 0)
             && (board->castleRights & BLACK_KING_RIGHTS)
@@ -311,6 +331,8 @@ void genAllQuietMoves(Board* board, uint16_t* moves, int* size){
     }
 }
 
+GENERATE_BY_COLOUR(genAllQuietMoves, genQuietMovesByColour)
+
 int isNotInCheck(Board* board, int colour){
     int kingsq = getlsb(board->colours[colour] & board->pieces[KING]);
     assert(board->squares[kingsq] == WHITE_KING + colour);
@@ -319,6 +341,10 @@ int isNotInCheck(Board* board, int colour){
 
 int squareIsAttacked(Board* board, int colour, int sq){
 
+#ifdef USE_ATTACK_CACHE
+    return testBit(board->attackedBy[!colour], sq);
+#endif
+
     uint64_t friendly = board->colours[ colour];
     uint64_t enemy    = board->colours[!colour];
     uint64_t occupied = friendly | enemy;
@@ -360,6 +386,82 @@ uint64_t allAttackersToSquare(Board* board, uint64_t occupied, int sq){
 }
 
 uint64_t attackersToKingSquare(Board* board){
+
     int kingsq = getlsb(board->colours[board->turn] & board->pieces[KING]);
+
+#ifdef USE_ATTACK_CACHE
+    // Only look for the attackers themselves when the king is in check
+    if (!testBit(board->attackedBy[!board->turn], kingsq)) return 0ull;
+#endif
+
     return attackersToSquare(board, board->turn, kingsq);
 }
+
+#ifdef USE_ATTACK_CACHE
+
+static uint64_t pieceAttacksFrom(Board* board, uint64_t occupied, int sq){
+
+    const int piece = board->squares[sq];
+
+    switch (pieceType(piece)){
+        case PAWN   : return pawnAttacks(pieceColour(piece), sq);
+        case KNIGHT : return knightAttacks(sq);
+        case BISHOP : return bishopAttacks(sq, occupied);
+        case ROOK   : return rookAttacks(sq, occupied);
+        case QUEEN  : return queenAttacks(sq, occupied);
+        case KING   : return kingAttacks(sq);
+        default     : return 0ull;
+    }
+}
+
+static void unionAttackCache(Board* board){
+
+    for (int colour = WHITE; colour <= BLACK; colour++){
+
+        uint64_t pieces = board->colours[colour], attacked = 0ull;
+
+        while (pieces)
+            attacked |= board->attacks[poplsb(&pieces)];
+
+        board->attackedBy[colour] = attacked;
+    }
+}
+
+void initAttackCache(Board* board){
+
+    uint64_t occupied = board->colours[WHITE] | board->colours[BLACK];
+
+    for (int sq = 0; sq < SQUARE_NB; sq++)
+        board->attacks[sq] = pieceAttacksFrom(board, occupied, sq);
+
+    unionAttackCache(board);
+}
+
+void updateAttackCache(Board* board, uint64_t changed){
+
+    // Called once the occupancy of the changed squares has been modified,
+    // when making or unmaking a move. The pieces on those squares must be
+    // recomputed, as must every slider which now sees one of those squares.
+    // A slider whose view was opened or closed by the move sees the changed
+    // square responsible for that, so no other slider needs to be touched
+
+    uint64_t occupied = board->colours[WHITE] | board->colours[BLACK];
+    uint64_t bishops  = board->pieces[BISHOP] | board->pieces[QUEEN];
+    uint64_t rooks    = board->pieces[ROOK  ] | board->pieces[QUEEN];
+    uint64_t dirty    = changed;
+
+    while (changed){
+        int sq = poplsb(&changed);
+        dirty |= (bishopAttacks(sq, occupied) & bishops)
+              |  (rookAttacks(sq, occupied) & rooks);
+    }
+
+    while (dirty){
+        int sq = poplsb(&dirty);
+        board->attacks[sq] = pieceAttacksFrom(board, occupied, sq);
+    }
+
+    unionAttackCache(board);
+}
+
+#endif
@@ -41,4 +41,9 @@ uint64_t attackersToSquare(Board* board, int colour, int sq);
 uint64_t allAttackersToSquare(Board* board, uint64_t occupied, int sq);
 uint64_t attackersToKingSquare(Board* board);
 
+#ifdef USE_ATTACK_CACHE
+void initAttackCache(Board* board);
+void updateAttackCache(Board* board, uint64_t changed);
+#endif
+
 #endif
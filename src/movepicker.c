@@ -19,6 +19,10 @@
 #include <assert.h>
 #include <stdlib.h>
 
+#if defined(__AVX2__)
+    #include <immintrin.h>
+#endif
+
 #include "attacks.h"
 #include "board.h"
 #include "bitboards.h"
@@ -287,6 +291,41 @@ int getBestMoveIndex(MovePicker *mp, int start, int end) {
 
     int best = start;
 
+#if defined(__AVX2__)
+
+    // Find the largest value eight at a time, and then the first index
+    // holding it. This is the same index as the scalar scan would pick,
+    // so the ordering of moves, and therefore the search, is unchanged
+    if (end - start >= 16) {
+
+        const int *values = mp->values;
+        int i, max;
+
+        __m256i vmax = _mm256_loadu_si256((const __m256i*) &values[start]);
+        for (i = start + 8; i + 8 <= end; i += 8)
+            vmax = _mm256_max_epi32(vmax, _mm256_loadu_si256((const __m256i*) &values[i]));
+
+        __m128i m = _mm_max_epi32(_mm256_castsi256_si128(vmax), _mm256_extracti128_si256(vmax, 1));
+        m = _mm_max_epi32(m, _mm_shuffle_epi32(m, 0x4E));
+        m = _mm_max_epi32(m, _mm_shuffle_epi32(m, 0xB1));
+        max = _mm_cvtsi128_si32(m);
+
+        for (; i < end; i++)
+            max = MAX(max, values[i]);
+
+        const __m256i target = _mm256_set1_epi32(max);
+        for (i = start; i + 8 <= end; i += 8) {
+            __m256i equal = _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i*) &values[i]), target);
+            int mask = _mm256_movemask_ps(_mm256_castsi256_ps(equal));
+            if (mask) return i + __builtin_ctz(mask);
+        }
+
+        while (values[i] != max) i++;
+        return i;
+    }
+
+#endif
+
     for (int i = start + 1; i < end; i++)
         if (mp->values[i] > mp->values[best])
             best = i;
@@ -315,6 +354,10 @@ void evaluateNoisyMoves(MovePicker* mp){
         else if (MoveType(mp->moves[i]) == ENPASS_MOVE)
             mp->values[i] = PieceValues[PAWN][EG] - PAWN;
 
+        // Adjust by the Capture History, which may reorder captures of a similar
+        // value, but may not flag a move as a bad noisy, so the score stays >= 0
+        mp->values[i] = MAX(0, mp->values[i] + getCaptureHistoryScore(mp->thread, mp->moves[i]) / 64);
+
         // Later we will flag moves which were passed over in the STAGE_GOOD_NOISY
         // phase due to failing an SEE(0), by setting the value to -1
         assert(mp->values[i] >= 0);
@@ -0,0 +1,365 @@
+/*
+  Ethereal is a UCI chess playing engine authored by Andrew Grant.
+  <https://github.com/AndyGrant/Ethereal>     <andrew@grantnet.us>
+
+  Ethereal is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Ethereal is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+#if defined(__AVX2__) || defined(__SSE2__)
+    #include <immintrin.h>
+#elif defined(__ARM_NEON)
+    #include <arm_neon.h>
+#endif
+
+#include "bitboards.h"
+#include "board.h"
+#include "castle.h"
+#include "move.h"
+#include "nnue.h"
+#include "types.h"
+
+#define NNUE_HEADER_SIZE (32)
+
+#define NNUE_FILE_SIZE (NNUE_HEADER_SIZE                                    \
+    + sizeof(int16_t) * NNUE_INPUTS * NNUE_HIDDEN                           \
+    + sizeof(int16_t) * NNUE_HIDDEN                                         \
+    + sizeof(int16_t) * NNUE_HIDDEN * 2                                     \
+    + sizeof(int32_t))
+
+int UseNNUE; // Set by the UseNNUE UCI option
+
+static struct {
+    const int16_t *ftWeights;   // [NNUE_INPUTS][NNUE_HIDDEN]
+    const int16_t *ftBiases;    // [NNUE_HIDDEN]
+    const int16_t *outWeights;  // [2][NNUE_HIDDEN]
+    int32_t outBias, scale;
+    void *data;                 // Start of the mapping or buffer
+} Network;
+
+static uint32_t readU32(const uint8_t *p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void unloadNetwork() {
+
+    if (Network.data == NULL)
+        return;
+
+#ifdef _WIN32
+    free(Network.data);
+#else
+    munmap(Network.data, NNUE_FILE_SIZE);
+#endif
+
+    memset(&Network, 0, sizeof(Network));
+}
+
+static void *readNetwork(const char *path) {
+
+#ifdef _WIN32
+
+    // No mmap() here, so read the whole file into one buffer
+    FILE *fin = fopen(path, "rb");
+    if (fin == NULL) return NULL;
+
+    void *data = malloc(NNUE_FILE_SIZE);
+    size_t bytes = fread(data, 1, NNUE_FILE_SIZE, fin);
+    int trailing = fgetc(fin) != EOF;
+    fclose(fin);
+
+    if (bytes != NNUE_FILE_SIZE || trailing)
+        return free(data), NULL;
+
+    return data;
+
+#else
+
+    struct stat st;
+    int fd = open(path, O_RDONLY);
+    if (fd == -1) return NULL;
+
+    if (fstat(fd, &st) == -1 || (size_t) st.st_size != NNUE_FILE_SIZE)
+        return close(fd), NULL;
+
+    void *data = mmap(NULL, NNUE_FILE_SIZE, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // The mapping stays valid once the descriptor is closed
+
+    return data == MAP_FAILED ? NULL : data;
+
+#endif
+}
+
+int nnueLoad(const char *path) {
+
+    unloadNetwork();
+
+    uint8_t *data = readNetwork(path);
+    if (data == NULL) return 0;
+
+    Network.data = data;
+
+    // Verify the header matches this build, see nnue.h for the format
+    if (   memcmp(data, "ENNU", 4)
+        || readU32(data +  4) != NNUE_VERSION
+        || readU32(data +  8) != NNUE_INPUTS
+        || readU32(data + 12) != NNUE_HIDDEN){
+        unloadNetwork();
+        return 0;
+    }
+
+    // Point directly into the mapped file. The SIMD kernels below make only
+    // unaligned loads from the network, so no copy or realignment is needed
+    Network.scale      = (int32_t) readU32(data + 16);
+    Network.ftWeights  = (const int16_t*) (data + NNUE_HEADER_SIZE);
+    Network.ftBiases   = Network.ftWeights + NNUE_INPUTS * NNUE_HIDDEN;
+    Network.outWeights = Network.ftBiases  + NNUE_HIDDEN;
+    Network.outBias    = (int32_t) readU32((const uint8_t*) (Network.outWeights + 2 * NNUE_HIDDEN));
+
+    return 1;
+}
+
+int nnueIsLoaded() {
+    return Network.data != NULL;
+}
+
+const char *nnueKernel() {
+#if defined(__AVX2__)
+    return "avx2";
+#elif defined(__SSE2__)
+    return "sse2";
+#elif defined(__ARM_NEON)
+    return "neon";
+#else
+    return "scalar";
+#endif
+}
+
+static int nnueFeature(int colour, int piece, int sq) {
+    return 64 * (6 * (pieceColour(piece) != colour) + pieceType(piece))
+         + (colour == WHITE ? sq : sq ^ 56);
+}
+
+static const int16_t *featureRow(int colour, int piece, int sq) {
+    return Network.ftWeights + NNUE_HIDDEN * nnueFeature(colour, piece, sq);
+}
+
+// Vector primitives for the accumulator kernels. Each kernel is written once
+// in terms of these, with the scalar build using one lane per "vector"
+
+#if defined(__AVX2__)
+    typedef __m256i vec_t;
+    #define VEC_LANES (16)
+    #define vecLoad(p)     _mm256_loadu_si256((const __m256i*)(p))
+    #define vecStore(p, v) _mm256_storeu_si256((__m256i*)(p), (v))
+    #define vecAdd(a, b)   _mm256_add_epi16((a), (b))
+    #define vecSub(a, b)   _mm256_sub_epi16((a), (b))
+#elif defined(__SSE2__)
+    typedef __m128i vec_t;
+    #define VEC_LANES (8)
+    #define vecLoad(p)     _mm_loadu_si128((const __m128i*)(p))
+    #define vecStore(p, v) _mm_storeu_si128((__m128i*)(p), (v))
+    #define vecAdd(a, b)   _mm_add_epi16((a), (b))
+    #define vecSub(a, b)   _mm_sub_epi16((a), (b))
+#elif defined(__ARM_NEON)
+    typedef int16x8_t vec_t;
+    #define VEC_LANES (8)
+    #define vecLoad(p)     vld1q_s16((p))
+    #define vecStore(p, v) vst1q_s16((p), (v))
+    #define vecAdd(a, b)   vaddq_s16((a), (b))
+    #define vecSub(a, b)   vsubq_s16((a), (b))
+#else
+    typedef int16_t vec_t;
+    #define VEC_LANES (1)
+    #define vecLoad(p)     (*(p))
+    #define vecStore(p, v) (*(p) = (v))
+    #define vecAdd(a, b)   ((int16_t) ((a) + (b)))
+    #define vecSub(a, b)   ((int16_t) ((a) - (b)))
+#endif
+
+static void updateRows(int16_t *dst, const int16_t *src,
+                       const int16_t *adds[], int nadds,
+                       const int16_t *subs[], int nsubs) {
+
+    for (int i = 0; i < NNUE_HIDDEN; i += VEC_LANES) {
+
+        vec_t v = vecLoad(src + i);
+
+        for (int j = 0; j < nadds; j++)
+            v = vecAdd(v, vecLoad(adds[j] + i));
+
+        for (int j = 0; j < nsubs; j++)
+            v = vecSub(v, vecLoad(subs[j] + i));
+
+        vecStore(dst + i, v);
+    }
+}
+
+static int32_t clippedDot(const int16_t *values, const int16_t *weights) {
+
+#if defined(__AVX2__)
+
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i clip = _mm256_set1_epi16(NNUE_CLIP);
+    __m256i sum = _mm256_setzero_si256();
+
+    for (int i = 0; i < NNUE_HIDDEN; i += 16) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(values + i));
+        __m256i w = _mm256_loadu_si256((const __m256i*)(weights + i));
+        v   = _mm256_min_epi16(_mm256_max_epi16(v, zero), clip);
+        sum = _mm256_add_epi32(sum, _mm256_madd_epi16(v, w));
+    }
+
+    __m128i s = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(1, 0, 3, 2)));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(s);
+
+#elif defined(__SSE2__)
+
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i clip = _mm_set1_epi16(NNUE_CLIP);
+    __m128i sum = _mm_setzero_si128();
+
+    for (int i = 0; i < NNUE_HIDDEN; i += 8) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(values + i));
+        __m128i w = _mm_loadu_si128((const __m128i*)(weights + i));
+        v   = _mm_min_epi16(_mm_max_epi16(v, zero), clip);
+        sum = _mm_add_epi32(sum, _mm_madd_epi16(v, w));
+    }
+
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(sum);
+
+#elif defined(__ARM_NEON)
+
+    const int16x8_t zero = vdupq_n_s16(0);
+    const int16x8_t clip = vdupq_n_s16(NNUE_CLIP);
+    int32x4_t sum = vdupq_n_s32(0);
+
+    for (int i = 0; i < NNUE_HIDDEN; i += 8) {
+        int16x8_t v = vminq_s16(vmaxq_s16(vld1q_s16(values + i), zero), clip);
+        int16x8_t w = vld1q_s16(weights + i);
+        sum = vmlal_s16(sum, vget_low_s16(v), vget_low_s16(w));
+        sum = vmlal_s16(sum, vget_high_s16(v), vget_high_s16(w));
+    }
+
+    return vgetq_lane_s32(sum, 0) + vgetq_lane_s32(sum, 1)
+         + vgetq_lane_s32(sum, 2) + vgetq_lane_s32(sum, 3);
+
+#else
+
+    int32_t sum = 0;
+
+    for (int i = 0; i < NNUE_HIDDEN; i++)
+        sum += MIN(MAX(values[i], 0), NNUE_CLIP) * weights[i];
+
+    return sum;
+
+#endif
+}
+
+void nnueRefresh(NNUEAccumulator *acc, Board *board) {
+
+    assert(nnueIsLoaded());
+
+    for (int colour = WHITE; colour <= BLACK; colour++) {
+
+        const int16_t *rows[32];
+        int count = 0;
+
+        uint64_t occupied = board->colours[WHITE] | board->colours[BLACK];
+        while (occupied) {
+            int sq = poplsb(&occupied);
+            rows[count++] = featureRow(colour, board->squares[sq], sq);
+        }
+
+        updateRows(acc->values[colour], Network.ftBiases, rows, count, NULL, 0);
+    }
+}
+
+void nnueUpdate(Board *board, uint16_t move, int capturePiece) {
+
+    // Called by applyMove() once the pieces are on their new squares, but
+    // before the turn has been passed. Pushes a new accumulator on the stack
+
+    const NNUEAccumulator *src = board->acc;
+    NNUEAccumulator *dst = ++board->acc;
+
+    const int from = MoveFrom(move), to = MoveTo(move);
+    const int moved = board->squares[to];
+
+    int addPieces[2], addSquares[2], nadds = 0;
+    int subPieces[2], subSquares[2], nsubs = 0;
+
+    // The moving piece, or the promoted piece, arrives on the to square
+    addPieces[nadds] = moved, addSquares[nadds++] = to;
+
+    if (MoveType(move) == PROMOTION_MOVE)
+        subPieces[nsubs] = makePiece(PAWN, board->turn), subSquares[nsubs++] = from;
+    else
+        subPieces[nsubs] = moved, subSquares[nsubs++] = from;
+
+    if (MoveType(move) == CASTLE_MOVE) {
+        addPieces[nadds] = makePiece(ROOK, board->turn), addSquares[nadds++] = castleGetRookTo(from, to);
+        subPieces[nsubs] = makePiece(ROOK, board->turn), subSquares[nsubs++] = castleGetRookFrom(from, to);
+    }
+
+    else if (MoveType(move) == ENPASS_MOVE)
+        subPieces[nsubs] = capturePiece, subSquares[nsubs++] = to ^ 8;
+
+    else if (capturePiece != EMPTY)
+        subPieces[nsubs] = capturePiece, subSquares[nsubs++] = to;
+
+    for (int colour = WHITE; colour <= BLACK; colour++) {
+
+        const int16_t *adds[2], *subs[2];
+
+        for (int i = 0; i < nadds; i++)
+            adds[i] = featureRow(colour, addPieces[i], addSquares[i]);
+
+        for (int i = 0; i < nsubs; i++)
+            subs[i] = featureRow(colour, subPieces[i], subSquares[i]);
+
+        updateRows(dst->values[colour], src->values[colour], adds, nadds, subs, nsubs);
+    }
+}
+
+int nnueEvaluate(Board *board) {
+
+    const int16_t *stm  = board->acc->values[ board->turn];
+    const int16_t *nstm = board->acc->values[!board->turn];
+
+    int64_t output = Network.outBias
+                   + clippedDot(stm,  Network.outWeights)
+                   + clippedDot(nstm, Network.outWeights + NNUE_HIDDEN);
+
+    int eval = output * Network.scale / (NNUE_CLIP * NNUE_OUTPUT_Q);
+
+    // Keep clear of the scores reserved for mates
+    return MAX(MATED_IN_MAX + 1, MIN(MATE_IN_MAX - 1, eval));
+}
@@ -0,0 +1,73 @@
+/*
+  Ethereal is a UCI chess playing engine authored by Andrew Grant.
+  <https://github.com/AndyGrant/Ethereal>     <andrew@grantnet.us>
+
+  Ethereal is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Ethereal is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+#include "types.h"
+
+// An efficiently updatable network, used in place of evaluateBoard() when the
+// UseNNUE option is set and a network has been loaded through EvalFile. The
+// network is 2x(768 -> NNUE_HIDDEN) -> 1. Each perspective has an accumulator
+// holding the first layer, which applyMove() updates from its parent, so that
+// an evaluation only has to run the clipped output layer.
+//
+// Network files are little-endian and laid out as follows. The first layer is
+// stored by feature, so that a feature's weights are one contiguous row.
+//
+//   Offset  Type     Count            Field
+//   0       char     4                Magic, "ENNU"
+//   4       uint32   1                Version, NNUE_VERSION
+//   8       uint32   1                Input features, NNUE_INPUTS
+//   12      uint32   1                Hidden neurons, NNUE_HIDDEN
+//   16      int32    1                Output scale, in centipawns
+//   20      uint32   3                Reserved, zero
+//   32      int16    768 x HIDDEN     First layer weights, by feature
+//   ...     int16    HIDDEN           First layer biases
+//   ...     int16    2 x HIDDEN       Output weights, side to move first
+//   ...     int32    1                Output bias
+//
+// A feature is indexed, for the perspective of colour c, by
+//
+//   64 * (6 * (pieceColour != c) + pieceType) + (c == WHITE ? sq : sq ^ 56)
+//
+// Hidden neurons are clipped to [0, NNUE_CLIP] before the output layer, and
+// the final evaluation is (output * scale) / (NNUE_CLIP * NNUE_OUTPUT_Q).
+
+enum {
+    NNUE_VERSION  = 1,
+    NNUE_INPUTS   = 768,
+    NNUE_HIDDEN   = 256,
+    NNUE_CLIP     = 255,
+    NNUE_OUTPUT_Q = 64,
+};
+
+struct NNUEAccumulator {
+    int16_t values[COLOUR_NB][NNUE_HIDDEN];
+};
+
+extern int UseNNUE;
+
+int nnueLoad(const char *path);
+int nnueIsLoaded();
+const char *nnueKernel();
+
+void nnueRefresh(NNUEAccumulator *acc, Board *board);
+void nnueUpdate(Board *board, uint16_t move, int capturePiece);
+int nnueEvaluate(Board *board);
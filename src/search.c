@@ -49,6 +49,10 @@ int LMRTable[64][64]; // Late Move Reductions, LMRTable[depth][played]
 
 volatile int ABORT_SIGNAL; // Global ABORT flag for threads
 
+volatile int IS_PONDERING; // Global PONDER flag for threads
+
+int MultiPV = 1; // Number of principal variations to search and report
+
 pthread_mutex_t LOCK = PTHREAD_MUTEX_INITIALIZER; // Global LOCK for threads
 
 void initSearch(){
@@ -59,25 +63,31 @@ void initSearch(){
             LMRTable[d][p] = 0.75 + log(d) * log(p) / 2.25;
 }
 
-uint16_t getBestMove(Thread* threads, Board* board, Limits* limits){
-
-    ABORT_SIGNAL = 0; // Clear the ABORT signal for the new search
+uint16_t getBestMove(Thread* threads, Board* board, Limits* limits, uint16_t* ponder){
 
     updateTT(); // Table is on a new search, thus a new generation
 
+    *ponder = NONE_MOVE; // Only set if the PV has a reply for the best move
+
     // Before searching, check to see if we are in the Syzygy Tablebases. If so
     // the probe will return 1, will initialize the best move, and will report
     // a depth MAX_PLY - 1 search to the interface. If found, we are done here.
-    uint16_t move; if (tablebasesProbeDTZ(board, &move)) return move;
+    // The probe is skipped when the interface restricts the root moves.
+    uint16_t move;
+    if (!limits->searchMoveCount && tablebasesProbeDTZ(board, &move)) return move;
 
     // Initialize SearchInfo, used for reporting and time managment logic
     SearchInfo info;
     memset(&info, 0, sizeof(SearchInfo));
     initTimeManagment(&info, limits);
+    info.pondering = IS_PONDERING;
 
     // Setup the thread pool for a new search
     newSearchThreadPool(threads, board, limits, &info);
 
+    // Never search more PV slots than there are root moves to search
+    info.multiPVs = MAX(1, MIN(MultiPV, threads[0].rootMoveCount));
+
     // Launch all of the threads
     pthread_t pthreads[threads[0].nthreads];
     for (int i = 1; i < threads[0].nthreads; i++)
@@ -88,10 +98,129 @@ uint16_t getBestMove(Thread* threads, Board* board, Limits* limits){
     for (int i = 1; i < threads[0].nthreads; i++)
         pthread_join(pthreads[i], NULL);
 
-    // Return highest depth best move
+    // Return highest depth best move, and the reply we expect to it
+    *ponder = info.ponderMoves[info.depth];
     return info.bestMoves[info.depth];
 }
 
+static int nodeLimitReached(Thread* thread){
+
+    // Only the main thread enforces the node limit, summing the counters
+    // of the pool. Callers keep this cheap by checking every 1024 nodes
+    return thread->limits->limitedByNodes
+        && thread == &thread->threads[0]
+        && nodesSearchedThreadPool(thread->threads) >= thread->limits->nodeLimit;
+}
+
+static inline uint16_t selectNextRootMove(Thread* thread, int* index){
+    return *index < thread->rootMoveCount ? thread->rootMoves[(*index)++].move : NONE_MOVE;
+}
+
+static int stillPondering(Thread* thread){
+
+    // The interface clears IS_PONDERING on a ponderhit or a stop. The main
+    // thread then rebudgets the search, now that the clock is running. The
+    // helpers keep treating the search as a ponder until that is done
+    if (!thread->info->pondering) return 0;
+    if (IS_PONDERING || thread != &thread->threads[0]) return 1;
+
+    ponderHitTimeManagment(thread->info, thread->limits);
+    thread->info->pondering = 0;
+    return 0;
+}
+
+void initRootMoves(Thread* thread){
+
+    Limits* const limits = thread->limits;
+
+    int size = 0; uint16_t moves[MAX_MOVES];
+    genAllLegalMoves(&thread->board, moves, &size);
+
+    thread->multiPV = 0;
+    thread->rootMoveCount = 0;
+    thread->rootMoves[0].move = NONE_MOVE;
+    thread->rootMoves[0].value = -MATE;
+    thread->rootMoves[0].length = 0;
+
+    for (int i = 0; i < size; i++) {
+
+        // Only search the moves given by go searchmoves, if there were any
+        if (limits->searchMoveCount) {
+            int j = 0;
+            while (j < limits->searchMoveCount && limits->searchMoves[j] != moves[i]) j++;
+            if (j == limits->searchMoveCount) continue;
+        }
+
+        RootMove* const rm = &thread->rootMoves[thread->rootMoveCount++];
+        rm->move = moves[i];
+        rm->value = rm->previousValue = -MATE;
+        rm->nodes = rm->previousNodes = 0ull;
+        rm->length = 0;
+    }
+}
+
+static void sortRootMoves(Thread* thread, int start, int end, int byNodes){
+
+    // A stable insertion sort, either by value or by the nodes searched in
+    // the previous iteration, so that ties keep their earlier order
+    for (int i = start + 1; i < end; i++) {
+
+        RootMove rm = thread->rootMoves[i]; int j;
+
+        for (j = i; j > start; j--) {
+            RootMove* const prev = &thread->rootMoves[j-1];
+            if (byNodes ? prev->previousNodes >= rm.previousNodes : prev->value >= rm.value) break;
+            thread->rootMoves[j] = *prev;
+        }
+
+        thread->rootMoves[j] = rm;
+    }
+}
+
+static void prepareRootMoves(Thread* thread, int multiPVs){
+
+    // Start a new iteration. Values are only kept for the moves searched
+    // in this iteration, while the old values centre aspiration windows
+    for (int i = 0; i < thread->rootMoveCount; i++) {
+        RootMove* const rm = &thread->rootMoves[i];
+        rm->previousValue = rm->value;
+        rm->previousNodes = rm->nodes;
+        rm->value = -MATE;
+        rm->nodes = 0ull;
+    }
+
+    // The best moves of the last iteration hold the first slots. The rest are
+    // tried in order of the effort the last iteration needed to refute them
+    sortRootMoves(thread, multiPVs, thread->rootMoveCount, 1);
+}
+
+static double rootMoveEffort(Thread* thread){
+
+    uint64_t total = 0ull;
+
+    // Fraction of this iteration's root nodes which went to the best move
+    for (int i = 0; i < thread->rootMoveCount; i++)
+        total += thread->rootMoves[i].nodes;
+
+    return total ? (double) thread->rootMoves[0].nodes / total : 1.0;
+}
+
+static void updateRootMove(RootMove* rm, int value, int alpha, int played, PVariation* pv){
+
+    // Moves which failed to raise alpha only have an upper bound, so they
+    // are sorted behind the moves with a real value. The first move keeps
+    // its value, so that it stays in front after the search fails low
+    if (played != 1 && value <= alpha) {
+        rm->value = -MATE;
+        return;
+    }
+
+    rm->value  = value;
+    rm->length = 1 + pv->length[1];
+    rm->line[0] = rm->move;
+    memcpy(rm->line + 1, pv->line[1], sizeof(uint16_t) * pv->length[1]);
+}
+
 void* iterativeDeepening(void* vthread){
 
     Thread* const thread   = (Thread*) vthread;
@@ -129,9 +258,14 @@ void* iterativeDeepening(void* vthread){
         // If we abort to here, we stop searching
         if (setjmp(thread->jbuffer)) break;
 
-        // Perform the actual search for the current depth. Store each
-        // search into thread->value, to create aspiration windows
-        thread->value = value = aspirationWindow(thread, depth);
+        // Perform the actual search for the current depth, once for each PV
+        // slot. Each slot searches the root moves from its own index onwards,
+        // and centres its aspiration window on that root move's last value
+        prepareRootMoves(thread, info->multiPVs);
+        for (thread->multiPV = 0; thread->multiPV < info->multiPVs; thread->multiPV++)
+            aspirationWindow(thread, depth);
+        sortRootMoves(thread, 0, info->multiPVs, 0);
+        value = thread->rootMoves[0].value;
 
         // Helper threads need not worry about time and search info updates
         if (!mainThread) continue;
@@ -139,20 +273,27 @@ void* iterativeDeepening(void* vthread){
         // Update the Search Info structure for the main thread
         info->depth = depth;
         info->values[depth] = value;
-        info->bestMoves[depth] = thread->pv.line[0];
+        info->bestMoves[depth] = thread->rootMoves[0].move;
+        info->ponderMoves[depth] = thread->rootMoves[0].length > 1 ? thread->rootMoves[0].line[1] : NONE_MOVE;
+        info->bestMoveEffort[depth] = rootMoveEffort(thread);
         info->timeUsage[depth] = elapsedTime(info) - info->timeUsage[depth-1];
 
         // Send information about this search to the interface
-        uciReport(thread->threads, -MATE, MATE, value);
+        for (i = 0; i < info->multiPVs; i++)
+            uciReport(thread->threads, i, -MATE, MATE);
 
         // Update time allocation based on score and pv changes
         updateTimeManagment(info, limits, depth, value);
 
-        // Check for termination by any of the possible limits
-        if (   (limits->limitedByDepth && depth >= limits->depthLimit)
-            || (limits->limitedByTime  && elapsedTime(info) > limits->timeLimit)
-            || (limits->limitedBySelf  && elapsedTime(info) > info->idealUsage)
-            || (limits->limitedBySelf  && elapsedTime(info) > info->maxUsage))
+        // Check for termination by any of the possible limits. While pondering
+        // the clock is not ours to use, so only the depth limit may stop us
+        if (   (!thread->rootMoveCount)
+            || (limits->limitedByDepth && depth >= limits->depthLimit)
+            || (limits->limitedByNodes && nodeLimitReached(thread))
+            || (limits->limitedByMate  && value >= MATE - 2 * limits->mateLimit + 1)
+            || (limits->limitedByTime  && !stillPondering(thread) && elapsedTime(info) > limits->timeLimit)
+            || (limits->limitedBySelf  && !stillPondering(thread) && elapsedTime(info) > info->idealUsage)
+            || (limits->limitedBySelf  && !stillPondering(thread) && elapsedTime(info) > info->maxUsage))
             break;
     }
 
@@ -164,22 +305,28 @@ void* iterativeDeepening(void* vthread){
 int aspirationWindow(Thread* thread, int depth){
 
     const int mainThread = thread == &thread->threads[0];
+    const int slot = thread->multiPV;
 
     int alpha, beta, value, delta = 14;
 
     // Need a few searches to get a good window
-    if (depth <= 4)
-        return search(thread, &thread->pv, -MATE, MATE, depth, 0);
+    if (depth <= 4) {
+        value = search(thread, -MATE, MATE, depth, 0);
+        sortRootMoves(thread, slot, thread->rootMoveCount, 0);
+        if (!thread->rootMoveCount) thread->rootMoves[0].value = value;
+        return value;
+    }
 
     // Create the aspiration window
-    alpha = MAX(-MATE, thread->value - delta);
-    beta  = MIN( MATE, thread->value + delta);
+    alpha = MAX(-MATE, thread->rootMoves[slot].previousValue - delta);
+    beta  = MIN( MATE, thread->rootMoves[slot].previousValue + delta);
 
     // Keep trying larger windows until one works
     while (1) {
 
         // Perform the search on the modified window
-        value = search(thread, &thread->pv, alpha, beta, depth, 0);
+        value = search(thread, alpha, beta, depth, 0);
+        sortRootMoves(thread, slot, thread->rootMoveCount, 0);
 
         // Result was within our window
         if (value > alpha && value < beta)
@@ -187,7 +334,7 @@ int aspirationWindow(Thread* thread, int depth){
 
         // Report lower and upper bounds after at least 5 seconds
         if (mainThread && elapsedTime(thread->info) >= 5000)
-            uciReport(thread->threads, alpha, beta, value);
+            uciReport(thread->threads, slot, alpha, beta);
 
         // Search failed low
         if (value <= alpha) {
@@ -204,27 +351,32 @@ int aspirationWindow(Thread* thread, int depth){
     }
 }
 
-int search(Thread* thread, PVariation* pv, int alpha, int beta, int depth, int height){
+// search() and qsearch() are written once as always_inline bodies, taking the
+// node type as constant arguments. SEARCH_NODE() and QSEARCH_NODE() stamp out
+// a specialized copy per node type, letting the compiler fold away the PvNode
+// and RootNode conditions, and search() / qsearch() dispatch to those copies
 
-    const int PvNode   = (alpha != beta - 1);
-    const int RootNode = (height == 0);
+static inline __attribute__((always_inline))
+int searchNode(Thread* thread, int alpha, int beta, int depth, int height, const int PvNode, const int RootNode){
 
     Board* const board = &thread->board;
 
     unsigned tbresult;
-    int quiets = 0, played = 0, hist = 0, cmhist = 0, fuhist = 0;
+    int quiets = 0, captures = 0, played = 0, hist = 0, cmhist = 0, fuhist = 0;
     int ttHit, ttValue = 0, ttEval = 0, ttDepth = 0, ttBound = 0;
-    int i, R, newDepth, rAlpha, rBeta, oldAlpha = alpha;
+    int i, R, newDepth, rAlpha, rBeta, oldAlpha = alpha, rootIndex = thread->multiPV;
     int inCheck, isQuiet, improving, extension, skipQuiets = 0;
     int eval, value = -MATE, best = -MATE, futilityMargin = -MATE;
-    uint16_t move, ttMove = NONE_MOVE, bestMove = NONE_MOVE, quietsTried[MAX_MOVES];
+    uint16_t move, ttMove = NONE_MOVE, bestMove = NONE_MOVE;
 
-    Undo undo[1];
-    MovePicker movePicker;
+    SearchStack* const ss = &thread->ss[height];
+    Undo* const undo = ss->undo;
+    MovePicker* const movePicker = &ss->movePicker;
+    uint16_t* const quietsTried = ss->quietsTried;
+    uint16_t* const capturesTried = ss->capturesTried;
 
-    PVariation lpv;
-    lpv.length = 0;
-    pv->length = 0;
+    PVariation* const pv = &thread->pv;
+    pv->length[height] = 0;
 
     // Increment nodes counter for this Thread
     thread->nodes++;
@@ -237,12 +389,22 @@ int search(Thread* thread, PVariation* pv, int alpha, int beta, int depth, int h
     // not yet completed our depth one search, and therefore would have no best move
     if (   (thread->limits->limitedBySelf || thread->limits->limitedByTime)
         && (thread->nodes & 1023) == 1023
+        && !stillPondering(thread)
         &&  elapsedTime(thread->info) >= thread->info->maxUsage
         &&  thread->depth > 1)
         longjmp(thread->jbuffer, 1);
 
-    // Step 1B. Check to see if the master thread finished
-    if (ABORT_SIGNAL) longjmp(thread->jbuffer, 1);
+    // Step 1B. Check to see if the node limit has been reached, again only
+    // after the depth one search has given us a best move to play
+    if (   thread->limits->limitedByNodes
+        && (thread->nodes & 1023) == 1023
+        &&  thread->depth > 1
+        &&  nodeLimitReached(thread))
+        longjmp(thread->jbuffer, 1);
+
+    // Step 1C. Check to see if the master thread finished, or if the search
+    // was stopped, once the depth one search has given us a best move
+    if (ABORT_SIGNAL && thread->depth > 1) longjmp(thread->jbuffer, 1);
 
     // Step 2. Check for early exit conditions. Don't take early exits in
     // the RootNode, since this would prevent us from having a best move
@@ -253,6 +415,13 @@ int search(Thread* thread, PVariation* pv, int alpha, int beta, int depth, int h
         if (boardIsDrawn(board, height))
             return 0;
 
+        // Check to see if the side to move can force a repetition. If so,
+        // a draw is a lower bound on our score, which may cause a cutoff
+        if (alpha < 0 && boardHasUpcomingRepetition(board, height)){
+            alpha = oldAlpha = 0;
+            if (alpha >= beta) return alpha;
+        }
+
         // Check to see if we have exceeded the maxiumum search draft
         if (height >= MAX_PLY)
             return evaluateBoard(board, &thread->pktable);
@@ -266,8 +435,11 @@ int search(Thread* thread, PVariation* pv, int alpha, int beta, int depth, int h
     }
 
     // Step 3. Probe the Transposition Table, adjust the value, and consider cutoffs
+    thread->ttprobes++;
     if ((ttHit = getTTEntry(board->hash, &ttMove, &ttValue, &ttEval, &ttDepth, &ttBound))){
 
+        thread->tthits++; // Increment tthits counter for this thread
+
         ttValue = valueFromTT(ttValue, height); // Adjust any MATE scores
 
         // Only cut with a greater depth search, and do not return
@@ -289,7 +461,7 @@ int search(Thread* thread, PVariation* pv, int alpha, int beta, int depth, int h
         // No king attackers indicates we are not checked. We reduce the
         // node count here, in order to avoid counting this node twice
         if (!board->kingAttackers)
-            return thread->nodes--, qsearch(thread, pv, alpha, beta, height);
+            return thread->nodes--, qsearch(thread, alpha, beta, height);
 
         // Search expects depth to be greater than or equal to 0
         depth = 0;
@@ -343,7 +515,7 @@ int search(Thread* thread, PVariation* pv, int alpha, int beta, int depth, int h
         && !inCheck
         &&  depth <= RazorDepth
         &&  eval + RazorMargin < alpha)
-        return qsearch(thread, pv, alpha, beta, height);
+        return qsearch(thread, alpha, beta, height);
 
     // Step 8. Beta Pruning / Reverse Futility Pruning / Static Null
     // Move Pruning. If the eval is few pawns above beta then exit early
@@ -372,7 +544,7 @@ int search(Thread* thread, PVariation* pv, int alpha, int beta, int depth, int h
 
         thread->moveStack[height] = NULL_MOVE;
 
-        value = -search(thread, &lpv, -beta, -beta+1, depth-R, height+1);
+        value = -search(thread, -beta, -beta+1, depth-R, height+1);
 
         thread->moveStack[height] = NONE_MOVE;
 
@@ -392,9 +564,9 @@ int search(Thread* thread, PVariation* pv, int alpha, int beta, int depth, int h
 
         rBeta = MIN(beta + ProbCutMargin, MATE - MAX_PLY - 1);
 
-        initMovePicker(&movePicker, thread, NONE_MOVE, height);
+        initMovePicker(movePicker, thread, NONE_MOVE, height);
 
-        while ((move = selectNextMove(&movePicker, board, 1)) != NONE_MOVE){
+        while ((move = selectNextMove(movePicker, board, 1)) != NONE_MOVE){
 
             // Move should pass an SEE() to be worth at least rBeta
             if (!staticExchangeEvaluation(board, move, rBeta - eval))
@@ -411,11 +583,11 @@ int search(Thread* thread, PVariation* pv, int alpha, int beta, int depth, int h
             thread->pieceStack[height] = pieceType(board->squares[MoveTo(move)]);
 
             // Verify the move has promise using a depth 2 search
-            value = -search(thread, &lpv, -rBeta, -rBeta+1, 2, height+1);
+            value = -search(thread, -rBeta, -rBeta+1, 2, height+1);
 
             // Verify the move holds which a slightly reduced depth search
             if (value >= rBeta && depth > 6)
-                value = -search(thread, &lpv, -rBeta, -rBeta+1, depth-4, height+1);
+                value = -search(thread, -rBeta, -rBeta+1, depth-4, height+1);
 
             // Revert the board state
             revertMove(board, move, undo);
@@ -426,13 +598,16 @@ int search(Thread* thread, PVariation* pv, int alpha, int beta, int depth, int h
     }
 
     // Step 11. Internal Iterative Deepening. Searching PV nodes without
-    // a known good move can be expensive, so a reduced search first
-    if (    PvNode
+    // a known good move can be expensive, so a reduced search first. Not
+    // at the root, which orders its moves by the previous iteration, and
+    // whose RootMove values and node counts must come from this search
+    if (   !RootNode
+        &&  PvNode
         &&  ttMove == NONE_MOVE
         &&  depth >= IIDDepth){
 
         // Search with a reduced depth
-        value = search(thread, &lpv, alpha, beta, depth-2, height);
+        value = search(thread, alpha, beta, depth-2, height);
 
         // Probe for a new table move, and adjust any mate scores
         ttHit = getTTEntry(board->hash, &ttMove, &ttValue, &ttEval, &ttDepth, &ttBound);
@@ -440,12 +615,16 @@ int search(Thread* thread, PVariation* pv, int alpha, int beta, int depth, int h
     }
 
     // Step 12. Initialize the Move Picker and being searching through each
-    // move one at a time, until we run out or a move generates a cutoff
-    initMovePicker(&movePicker, thread, ttMove, height);
-    while ((move = selectNextMove(&movePicker, board, skipQuiets)) != NONE_MOVE){
+    // move one at a time, until we run out or a move generates a cutoff. The
+    // root instead walks its RootMove list, from the current MultiPV slot on
+    initMovePicker(movePicker, thread, ttMove, height);
+    while ((move = RootNode ? selectNextRootMove(thread, &rootIndex)
+                            : selectNextMove(movePicker, board, skipQuiets)) != NONE_MOVE){
+
+        const uint64_t startingNodes = thread->nodes;
 
         // If this move is quiet we will save it to a list of attemped quiets.
-        // Also lookup the history score, as we will in most cases need it.
+        // Also lookup the history score, as we will in most cases need it
         if ((isQuiet = !moveIsTactical(board, move))){
             quietsTried[quiets++] = move;
             cmhist = getCMHistoryScore(thread, height, move);
@@ -492,13 +671,13 @@ int search(Thread* thread, PVariation* pv, int alpha, int beta, int depth, int h
             continue;
 
         // Step 17. Static Exchange Evaluation Pruning. Prune moves which fail
-        // to beat a depth dependent SEE threshold. The use of movePicker.stage
+        // to beat a depth dependent SEE threshold. The use of movePicker->stage
         // is a speedup, which assumes that good noisy moves have a positive SEE
         if (   !RootNode
             && !inCheck
             &&  depth <= SEEPruningDepth
             &&  best > MATED_IN_MAX
-            &&  movePicker.stage > STAGE_GOOD_NOISY
+            &&  movePicker->stage > STAGE_GOOD_NOISY
             && !staticExchangeEvaluation(board, move, SEEMargin * depth * depth))
             continue;
 
@@ -515,6 +694,10 @@ int search(Thread* thread, PVariation* pv, int alpha, int beta, int depth, int h
         // Update counter of moves actually played
         played += 1;
 
+        // Save noisy moves which are actually searched, as only those have
+        // earned a Capture History penalty should another move fail high
+        if (!isQuiet) capturesTried[captures++] = move;
+
         // Step 18. Late Move Reductions. Compute the reduction,
         // allow the later steps to perform the reduced searches
         if (isQuiet && depth > 2 && played > 1){
@@ -528,9 +711,9 @@ int search(Thread* thread, PVariation* pv, int alpha, int beta, int depth, int h
             R += !improving;
 
             // Reduce for Killers and Counters
-            R -= move == movePicker.killer1
-              || move == movePicker.killer2
-              || move == movePicker.counter;
+            R -= move == movePicker->killer1
+              || move == movePicker->killer2
+              || move == movePicker->counter;
 
             // Adjust based on history
             R -= MAX(-2, MIN(2, hist / 5000));
@@ -562,25 +745,32 @@ int search(Thread* thread, PVariation* pv, int alpha, int beta, int depth, int h
         // Step 20A. If we triggered the LMR conditions (which we know by the value of R),
         // then we will perform a reduced search on the null alpha window, as we have no
         // expectation that this move will be worth looking into deeper
-        if (R != 1) value = -search(thread, &lpv, -alpha-1, -alpha, newDepth-R, height+1);
+        if (R != 1) value = -search(thread, -alpha-1, -alpha, newDepth-R, height+1);
 
         // Step 20B. There are two situations in which we will search again on a null window,
         // but without a depth reduction R. First, if the LMR search happened, and failed
         // high, secondly, if we did not try an LMR search, and this is not the first move
         // we have tried in a PvNode, we will research with the normally reduced depth
         if ((R != 1 && value > alpha) || (R == 1 && !(PvNode && played == 1)))
-            value = -search(thread, &lpv, -alpha-1, -alpha, newDepth-1, height+1);
+            value = -search(thread, -alpha-1, -alpha, newDepth-1, height+1);
 
         // Step 20C. Finally, if we are in a PvNode and a move beat alpha while being
         // search on a reduced depth, we will search again on the normal window. Also,
         // if we did not perform Step 18B, we will search for the first time on the
         // normal window. This happens only for the first move in a PvNode
         if (PvNode && (played == 1 || value > alpha))
-            value = -search(thread, &lpv, -beta, -alpha, newDepth-1, height+1);
+            value = -search(thread, -beta, -alpha, newDepth-1, height+1);
 
         // Revert the board state
         revertMove(board, move, undo);
 
+        // Record the value, PV and subtree size of each root move
+        if (RootNode) {
+            RootMove* const rm = &thread->rootMoves[rootIndex-1];
+            rm->nodes += thread->nodes - startingNodes;
+            updateRootMove(rm, value, alpha, played, pv);
+        }
+
         // Step 21. Update search stats for the best move and its value. Update
         // our lower bound (alpha) if exceeded, and also update the PV in that case
         if (value > best){
@@ -591,10 +781,13 @@ int search(Thread* thread, PVariation* pv, int alpha, int beta, int depth, int h
             if (value > alpha){
                 alpha = value;
 
-                // Copy our child's PV and prepend this move to it
-                pv->length = 1 + lpv.length;
-                pv->line[0] = move;
-                memcpy(pv->line + 1, lpv.line, sizeof(uint16_t) * lpv.length);
+                // Copy our child's PV and prepend this move to it. Only PV
+                // nodes need to do so, as nothing reads a NonPV node's line
+                if (PvNode){
+                    pv->length[height] = 1 + pv->length[height+1];
+                    pv->line[height][0] = move;
+                    memcpy(pv->line[height] + 1, pv->line[height+1], sizeof(uint16_t) * pv->length[height+1]);
+                }
             }
         }
 
@@ -634,27 +827,42 @@ int search(Thread* thread, PVariation* pv, int alpha, int beta, int depth, int h
         }
     }
 
-    // Step 24. Store results of search into the table
+    // Step 23B. Update Capture History counters on any fail high. A noisy best
+    // move is rewarded, and every other noisy move which was tried is penalized
+    if (best >= beta){
+
+        if (moveIsTactical(board, bestMove))
+            updateCaptureHistory(thread, bestMove, depth*depth);
+
+        for (i = 0; i < captures; i++)
+            if (capturesTried[i] != bestMove)
+                updateCaptureHistory(thread, capturesTried[i], -depth*depth);
+    }
+
+    // Step 24. Store results of search into the table. Later MultiPV slots
+    // exclude moves at the root, so their results do not belong in the table
     ttBound = best >= beta    ? BOUND_LOWER
             : best > oldAlpha ? BOUND_EXACT : BOUND_UPPER;
-    storeTTEntry(board->hash, bestMove, valueToTT(best, height), eval, depth, ttBound);
+    if (!RootNode || !thread->multiPV)
+        storeTTEntry(board->hash, bestMove, valueToTT(best, height), eval, depth, ttBound);
 
     return best;
 }
 
-int qsearch(Thread* thread, PVariation* pv, int alpha, int beta, int height){
+static inline __attribute__((always_inline))
+int qsearchNode(Thread* thread, int alpha, int beta, int height, const int PvNode){
 
     Board* const board = &thread->board;
 
     int eval, value, best;
     uint16_t move;
 
-    Undo undo[1];
-    MovePicker movePicker;
+    SearchStack* const ss = &thread->ss[height];
+    Undo* const undo = ss->undo;
+    MovePicker* const movePicker = &ss->movePicker;
 
-    PVariation lpv;
-    lpv.length = 0;
-    pv->length = 0;
+    PVariation* const pv = &thread->pv;
+    pv->length[height] = 0;
 
     // Increment nodes counter for this Thread
     thread->nodes++;
@@ -667,12 +875,22 @@ int qsearch(Thread* thread, PVariation* pv, int alpha, int beta, int height){
     // not yet completed our depth one search, and therefore would have no best move
     if (   (thread->limits->limitedBySelf || thread->limits->limitedByTime)
         && (thread->nodes & 1023) == 1023
+        && !stillPondering(thread)
         &&  elapsedTime(thread->info) >= thread->info->maxUsage
         &&  thread->depth > 1)
         longjmp(thread->jbuffer, 1);
 
-    // Step 1B. Check to see if the master thread finished
-    if (ABORT_SIGNAL) longjmp(thread->jbuffer, 1);
+    // Step 1B. Check to see if the node limit has been reached, again only
+    // after the depth one search has given us a best move to play
+    if (   thread->limits->limitedByNodes
+        && (thread->nodes & 1023) == 1023
+        &&  thread->depth > 1
+        &&  nodeLimitReached(thread))
+        longjmp(thread->jbuffer, 1);
+
+    // Step 1C. Check to see if the master thread finished, or if the search
+    // was stopped, once the depth one search has given us a best move
+    if (ABORT_SIGNAL && thread->depth > 1) longjmp(thread->jbuffer, 1);
 
     // Step 2. Draw Detection. Check for the fifty move rule,
     // a draw by repetition, or insufficient mating material
@@ -686,8 +904,9 @@ int qsearch(Thread* thread, PVariation* pv, int alpha, int beta, int height){
 
     // Step 4. Eval Pruning. If a static evaluation of the board will
     // exceed beta, then we can stop the search here. Also, if the static
-    // eval exceeds alpha, we can call our static eval the new alpha
-    best = value = eval = evaluateBoard(board, &thread->pktable);
+    // eval exceeds alpha, we can call our static eval the new alpha. The
+    // evaluation may stop early, once it is clearly outside of the window
+    best = value = eval = evaluateBoardLazy(thread, board, alpha, beta);
     alpha = MAX(alpha, value);
     if (alpha >= beta) return value;
 
@@ -698,8 +917,8 @@ int qsearch(Thread* thread, PVariation* pv, int alpha, int beta, int height){
 
     // Step 6. Move Generation and Looping. Generate all tactical,
     // moves, return and try the ones which pass an SEE(QSEEMargin)
-    initNoisyMovePicker(&movePicker, thread, QSEEMargin);
-    while ((move = selectNextMove(&movePicker, board, 1)) != NONE_MOVE){
+    initNoisyMovePicker(movePicker, thread, QSEEMargin);
+    while ((move = selectNextMove(movePicker, board, 1)) != NONE_MOVE){
 
         // Step 7. Futility Pruning. Similar to Delta Pruning, if
         // this capture in the best case would still fail to beat
@@ -718,7 +937,7 @@ int qsearch(Thread* thread, PVariation* pv, int alpha, int beta, int height){
         thread->pieceStack[height] = pieceType(board->squares[MoveTo(move)]);
 
         // Search next depth
-        value = -qsearch(thread, &lpv, -beta, -alpha, height+1);
+        value = -qsearch(thread, -beta, -alpha, height+1);
 
         // Revert move from board
         revertMove(board, move, undo);
@@ -732,9 +951,11 @@ int qsearch(Thread* thread, PVariation* pv, int alpha, int beta, int height){
                 alpha = value;
 
                 // Update the Principle Variation
-                pv->length = 1 + lpv.length;
-                pv->line[0] = move;
-                memcpy(pv->line + 1, lpv.line, sizeof(uint16_t) * lpv.length);
+                if (PvNode){
+                    pv->length[height] = 1 + pv->length[height+1];
+                    pv->line[height][0] = move;
+                    memcpy(pv->line[height] + 1, pv->line[height+1], sizeof(uint16_t) * pv->length[height+1]);
+                }
             }
         }
 
@@ -746,6 +967,38 @@ int qsearch(Thread* thread, PVariation* pv, int alpha, int beta, int height){
     return best;
 }
 
+#define SEARCH_NODE(name, PvNode, RootNode)                                       \
+    static int name(Thread* thread, int alpha, int beta, int depth, int height){  \
+        return searchNode(thread, alpha, beta, depth, height, PvNode, RootNode);  \
+    }
+
+#define QSEARCH_NODE(name, PvNode)                                                \
+    static int name(Thread* thread, int alpha, int beta, int height){             \
+        return qsearchNode(thread, alpha, beta, height, PvNode);                  \
+    }
+
+SEARCH_NODE(searchRoot,  1, 1)
+SEARCH_NODE(searchPV,    1, 0)
+SEARCH_NODE(searchNonPV, 0, 0)
+
+QSEARCH_NODE(qsearchPV,    1)
+QSEARCH_NODE(qsearchNonPV, 0)
+
+int search(Thread* thread, int alpha, int beta, int depth, int height){
+
+    // The root is always searched on an open window, see aspirationWindow()
+    assert(height != 0 || alpha != beta - 1);
+
+    return height == 0        ? searchRoot (thread, alpha, beta, depth, height)
+         : alpha != beta - 1  ? searchPV   (thread, alpha, beta, depth, height)
+         :                      searchNonPV(thread, alpha, beta, depth, height);
+}
+
+int qsearch(Thread* thread, int alpha, int beta, int height){
+    return alpha != beta - 1 ? qsearchPV   (thread, alpha, beta, height)
+         :                     qsearchNonPV(thread, alpha, beta, height);
+}
+
 int staticExchangeEvaluation(Board* board, uint16_t move, int threshold){
 
     int from, to, type, ptype, colour, balance, nextVictim;
@@ -911,7 +1164,6 @@ int moveIsSingular(Thread* thread, uint16_t ttMove, int ttValue, Undo* undo, int
 
     uint16_t move;
     MovePicker movePicker;
-    PVariation lpv; lpv.length = 0;
 
     // Table move was already applied, undo that
     revertMove(board, ttMove, undo);
@@ -934,7 +1186,7 @@ int moveIsSingular(Thread* thread, uint16_t ttMove, int ttValue, Undo* undo, int
         thread->pieceStack[height] = pieceType(board->squares[MoveTo(move)]);
 
         // Perform a reduced depth search on a null rbeta window
-        value = -search(thread, &lpv, -rBeta-1, -rBeta, depth / 2 - 1, height+1);
+        value = -search(thread, -rBeta-1, -rBeta, depth / 2 - 1, height+1);
 
         // Revert board state
         revertMove(board, move, undo);
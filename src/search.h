@@ -21,37 +21,61 @@
 
 #include <stdint.h>
 
+#include "board.h"
+#include "movepicker.h"
 #include "types.h"
 
 struct SearchInfo {
     int depth;
     int values[MAX_PLY];
     uint16_t bestMoves[MAX_PLY];
+    uint16_t ponderMoves[MAX_PLY];
+    double bestMoveEffort[MAX_PLY];
     double timeUsage[MAX_PLY];
     double startTime;
     double idealUsage;
     double maxAlloc;
     double maxUsage;
+    double effortScale;
     int bestMoveChanges;
+    int pondering;
+    int multiPVs;
 };
 
 struct PVariation {
-    uint16_t line[MAX_PLY];
+    uint16_t line[MAX_PLY+1][MAX_PLY+1]; // Triangular, line[height] is the PV from height
+    int length[MAX_PLY+1];
+};
+
+struct RootMove {
+    uint16_t move;
+    int value, previousValue;             // Values from this and the last iteration
+    uint64_t nodes, previousNodes;        // Subtree sizes from this and the last iteration
     int length;
+    uint16_t line[MAX_PLY+1];             // Last PV found starting with this move
+};
+
+struct SearchStack {
+    Undo undo[1];
+    MovePicker movePicker;
+    uint16_t quietsTried[MAX_MOVES];
+    uint16_t capturesTried[MAX_MOVES];
 };
 
 
 void initSearch();
 
-uint16_t getBestMove(Thread* threads, Board* board, Limits* limits);
+uint16_t getBestMove(Thread* threads, Board* board, Limits* limits, uint16_t* ponder);
+
+void initRootMoves(Thread* thread);
 
 void* iterativeDeepening(void* vthread);
 
 int aspirationWindow(Thread* thread, int depth);
 
-int search(Thread* thread, PVariation* pv, int alpha, int beta, int depth, int height);
+int search(Thread* thread, int alpha, int beta, int depth, int height);
 
-int qsearch(Thread* thread, PVariation* pv, int alpha, int beta, int height);
+int qsearch(Thread* thread, int alpha, int beta, int height);
 
 int staticExchangeEvaluation(Board* board, uint16_t move, int threshold);
 
@@ -0,0 +1,156 @@
+# Ethereal is a UCI chess playing engine authored by Andrew Grant.
+# <https://github.com/AndyGrant/Ethereal>     <andrew@grantnet.us>
+#
+# Ethereal is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# Ethereal is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+# Plays two builds against each other at a fixed time control, to validate
+# time management changes. Each position in bench.csv is played twice, once
+# with each build moving first. Games are adjudicated from the reported scores,
+# since the script does not track the board itself:
+#
+#   - A side with no legal moves reports "mate 0" (mated) or "cp 0" (stalemate)
+#   - Both sides agreeing on a score beyond 1000cp for 8 plies ends the game
+#   - Both sides agreeing on a score within 10cp for 20 plies, after 80 plies,
+#     or reaching 300 plies, is a draw
+#
+# Usage: python3 selfplay.py NEW BASE [SECONDS] [INCREMENT] [GAMES] [NODES]
+#
+# Reports the score of NEW against BASE, with an Elo estimate, and the mean
+# time each build spent per move, which is where a time management change
+# should show its savings. Given NODES, every move is instead searched to a
+# fixed number of nodes, and the clocks are ignored. This measures the
+# strength of a speed change, such as a cheaper evaluation, on its own.
+
+import math
+import subprocess
+import sys
+import time
+
+NEW, BASE   = sys.argv[1], sys.argv[2]
+SECONDS     = float(sys.argv[3]) if len(sys.argv) > 3 else 4.0
+INCREMENT   = float(sys.argv[4]) if len(sys.argv) > 4 else 0.04
+GAMES       = int(sys.argv[5]) if len(sys.argv) > 5 else 100
+NODES       = int(sys.argv[6]) if len(sys.argv) > 6 else 0
+
+class Engine:
+
+    def __init__(self, path):
+        self.process = subprocess.Popen(
+            path, stdin=subprocess.PIPE, stdout=subprocess.PIPE, universal_newlines=True)
+        self.used, self.moves = 0.0, 0
+        self.send("uci"); self.wait("uciok")
+
+    def send(self, line):
+        self.process.stdin.write(line + "\n")
+        self.process.stdin.flush()
+
+    def wait(self, token):
+        while True:
+            line = self.process.stdout.readline()
+            if line.startswith(token): return line
+
+    def newgame(self):
+        self.send("ucinewgame"); self.send("isready"); self.wait("readyok")
+
+    def go(self, fen, moves, clocks):
+        self.send("position fen %s moves %s" % (fen, " ".join(moves)))
+        if NODES: self.send("go nodes %d" % NODES)
+        else: self.send("go wtime %d btime %d winc %d binc %d" % (
+            clocks[0] * 1000, clocks[1] * 1000, INCREMENT * 1000, INCREMENT * 1000))
+
+        start, score = time.time(), None
+        while True:
+            line = self.process.stdout.readline().split()
+            if "score" in line:
+                index = line.index("score")
+                score = (line[index+1], int(line[index+2]))
+            if line and line[0] == "bestmove":
+                elapsed = time.time() - start
+                self.used += elapsed; self.moves += 1
+                return line[1], score, elapsed
+
+    def quit(self):
+        self.send("quit"); self.process.wait()
+
+def centipawns(score):
+    kind, value = score
+    if kind == "mate": return 100000 if value > 0 else -100000
+    return value
+
+def play(engines, fen):
+
+    # Returns 1, 0.5 or 0 from the point of view of engines[0], who always
+    # moves first. clocks[0] is theirs, whichever colour the FEN gives them
+    moves, clocks, history = [], [SECONDS, SECONDS], []
+    turn = 0 if fen.split()[1] == "w" else 1
+
+    for engine in engines: engine.newgame()
+
+    for ply in range(300):
+
+        side = ply % 2
+        move, score, elapsed = engines[side].go(fen, moves, clocks if turn == 0 else clocks[::-1])
+
+        clocks[side] -= elapsed
+        if clocks[side] < 0 and not NODES: return 0.0 if side == 0 else 1.0
+        clocks[side] += INCREMENT
+
+        if move in ("a1a1", "0000", "(none)"):
+            if score == ("mate", 0): return 0.0 if side == 0 else 1.0
+            return 0.5
+
+        moves.append(move)
+
+        # Scores from the point of view of engines[0]
+        history.append(centipawns(score) if side == 0 else -centipawns(score))
+
+        if len(history) >= 8 and all(s > 1000 for s in history[-8:]): return 1.0
+        if len(history) >= 8 and all(s < -1000 for s in history[-8:]): return 0.0
+        if ply >= 80 and all(abs(s) <= 10 for s in history[-20:]): return 0.5
+
+    return 0.5
+
+def elo(score):
+    score = min(max(score, 0.001), 0.999)
+    return -400 * math.log10(1 / score - 1)
+
+with open("bench.csv") as fin:
+    fens = [line.strip().strip(",").strip('"') for line in fin if line.strip()]
+
+new, base = Engine(NEW), Engine(BASE)
+wins = draws = losses = 0
+
+for game in range(GAMES):
+
+    fen = fens[(game // 2) % len(fens)]
+
+    # Alternate colours, so that every position is played from both sides
+    if game % 2 == 0: result = play([new, base], fen)
+    else:             result = 1.0 - play([base, new], fen)
+
+    wins   += result == 1.0
+    draws  += result == 0.5
+    losses += result == 0.0
+
+    played = wins + draws + losses
+    score  = (wins + draws / 2) / played
+    margin = 400 / math.log(10) * 1.96 * math.sqrt(max(score * (1 - score), 0.01) / played) \
+           / max(score * (1 - score), 0.01)
+
+    print("Games %3d  W %3d  D %3d  L %3d  Elo %+6.1f +- %5.1f  ms/move new %6.1f base %6.1f" % (
+        played, wins, draws, losses, elo(score), margin,
+        1000 * new.used / max(new.moves, 1), 1000 * base.used / max(base.moves, 1)))
+    sys.stdout.flush()
+
+new.quit(); base.quit()
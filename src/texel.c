@@ -187,9 +187,14 @@ void initTexelEntries(TexelEntry *tes, Thread *thread) {
     limits.limitedByNone  = 1;
     limits.limitedByTime  = 0;
     limits.limitedByDepth = 0;
+    limits.limitedByNodes = 0;
+    limits.limitedByMate  = 0;
     limits.limitedBySelf  = 0;
     limits.timeLimit      = 0;
     limits.depthLimit     = 0;
+    limits.nodeLimit      = 0;
+    limits.mateLimit      = 0;
+    limits.searchMoveCount = 0;
 
     // Initialize the thread for the search
     thread->limits = &limits;
@@ -222,6 +227,7 @@ void initTexelEntries(TexelEntry *tes, Thread *thread) {
 
         // Setup the board with the FEN from the FENS file
         boardFromFEN(&thread->board, line);
+        initRootMoves(thread);
 
         // Determine the game phase based on remaining material
         tes[i].phase = 24 - 4 * popcount(thread->board.pieces[QUEEN ])
@@ -238,14 +244,14 @@ void initTexelEntries(TexelEntry *tes, Thread *thread) {
 
         // Use a iterative deepening to get a predictive evaluation
         for (int depth = 0; depth <= NDEPTHS; depth++)
-            tes[i].eval = search(thread, &thread->pv, -MATE, MATE, depth, 0);
+            tes[i].eval = search(thread, -MATE, MATE, depth, 0);
         if (thread->board.turn == BLACK) tes[i].eval *= -1;
 
         // Resolve FEN to a quiet position
         if (RESOLVE) {
-            qsearch(thread, &thread->pv, -MATE, MATE, 0);
-            for (j = 0; j < thread->pv.length; j++)
-                applyMove(&thread->board, thread->pv.line[j], undo);
+            qsearch(thread, -MATE, MATE, 0);
+            for (j = 0; j < thread->pv.length[0]; j++)
+                applyMove(&thread->board, thread->pv.line[0][j], undo);
         }
 
         // Vectorize the evaluation coefficients
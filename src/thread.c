@@ -24,6 +24,7 @@
 #include "history.h"
 #include "search.h"
 #include "board.h"
+#include "nnue.h"
 #include "thread.h"
 #include "types.h"
 
@@ -64,6 +65,7 @@ void resetThreadPool(Thread* threads){
         memset(&threads[i].history,   0, sizeof(HistoryTable    ));
         memset(&threads[i].cmhistory, 0, sizeof(CMHistoryTable  ));
         memset(&threads[i].fuhistory, 0, sizeof(FUHistoryTable  ));
+        memset(&threads[i].chistory,  0, sizeof(CaptureHistoryTable));
         memset(&threads[i].cmtable,   0, sizeof(CounterMoveTable));
         memset(&threads[i].pktable,   0, sizeof(PawnKingTable   ));
     }
@@ -83,10 +85,24 @@ void newSearchThreadPool(Thread* threads, Board* board, Limits* limits, SearchIn
         // Make our own copy of the original position
         memcpy(&threads[i].board, board, sizeof(Board));
 
+        // Root an accumulator stack at our copy when using the network
+        threads[i].board.acc = NULL;
+        if (UseNNUE && nnueIsLoaded()){
+            threads[i].board.acc = threads[i].accumulators;
+            nnueRefresh(threads[i].board.acc, &threads[i].board);
+        }
+
+        // Build the list of moves to be searched at the root
+        initRootMoves(&threads[i]);
+
         // Zero out our depth and stat tracking
         threads[i].depth  = 0;
         threads[i].nodes  = 0ull;
         threads[i].tbhits = 0ull;
+        threads[i].ttprobes = 0ull;
+        threads[i].tthits = 0ull;
+        threads[i].lazyCalls = 0ull;
+        memset(threads[i].lazyExits, 0, sizeof(threads[i].lazyExits));
     }
 }
 
@@ -109,3 +125,43 @@ uint64_t tbhitsSearchedThreadPool(Thread* threads){
 
     return tbhits;
 }
+
+uint64_t ttprobesSearchedThreadPool(Thread* threads){
+
+    uint64_t ttprobes = 0ull;
+
+    for (int i = 0; i < threads[0].nthreads; i++)
+        ttprobes += threads[i].ttprobes;
+
+    return ttprobes;
+}
+
+uint64_t tthitsSearchedThreadPool(Thread* threads){
+
+    uint64_t tthits = 0ull;
+
+    for (int i = 0; i < threads[0].nthreads; i++)
+        tthits += threads[i].tthits;
+
+    return tthits;
+}
+
+uint64_t lazyCallsSearchedThreadPool(Thread* threads){
+
+    uint64_t lazyCalls = 0ull;
+
+    for (int i = 0; i < threads[0].nthreads; i++)
+        lazyCalls += threads[i].lazyCalls;
+
+    return lazyCalls;
+}
+
+uint64_t lazyExitsSearchedThreadPool(Thread* threads, int stage){
+
+    uint64_t lazyExits = 0ull;
+
+    for (int i = 0; i < threads[0].nthreads; i++)
+        lazyExits += threads[i].lazyExits[stage];
+
+    return lazyExits;
+}
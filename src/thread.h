@@ -21,6 +21,8 @@
 
 #include <setjmp.h>
 
+#include "evaluate.h"
+#include "nnue.h"
 #include "types.h"
 #include "transposition.h"
 #include "search.h"
@@ -33,12 +35,21 @@ struct Thread {
     Board board;
     PVariation pv;
 
-    int value;
+    SearchStack ss[MAX_PLY+1];
+
+    int multiPV;                           // Index of the PV slot being searched
+    int rootMoveCount;
+    RootMove rootMoves[MAX_MOVES];
+
     int depth;
     int seldepth;
 
     uint64_t nodes;
     uint64_t tbhits;
+    uint64_t ttprobes;
+    uint64_t tthits;
+    uint64_t lazyCalls;
+    uint64_t lazyExits[LAZY_STAGE_NB];
 
     int *evalStack;
     int _evalStack[MAX_PLY+4];
@@ -49,6 +60,8 @@ struct Thread {
     int *pieceStack;
     int _pieceStack[MAX_PLY+4];
 
+    NNUEAccumulator accumulators[MAX_PLY+1];
+
     jmp_buf jbuffer;
 
     int nthreads;
@@ -58,6 +71,7 @@ struct Thread {
     HistoryTable history;
     CMHistoryTable cmhistory;
     FUHistoryTable fuhistory;
+    CaptureHistoryTable chistory;
     CounterMoveTable cmtable;
     PawnKingTable pktable;
 };
@@ -73,4 +87,12 @@ uint64_t nodesSearchedThreadPool(Thread* threads);
 
 uint64_t tbhitsSearchedThreadPool(Thread* threads);
 
+uint64_t ttprobesSearchedThreadPool(Thread* threads);
+
+uint64_t tthitsSearchedThreadPool(Thread* threads);
+
+uint64_t lazyCallsSearchedThreadPool(Thread* threads);
+
+uint64_t lazyExitsSearchedThreadPool(Thread* threads, int stage);
+
 #endif
@@ -32,6 +32,12 @@
 
 int MoveOverhead = 100; // Set by UCI options
 
+int AutoMoveOverhead = 1; // Set by UCI options
+
+static double MeasuredLag = -1; // Interface lag per move, or -1 until measured
+static double LastClock   = -1; // Our clock when the last measured move began
+static double LastElapsed = -1; // Time from the go to the bestmove of that move
+
 
 double getRealTime(){
 #if defined(_WIN32) || defined(_WIN64)
@@ -60,6 +66,8 @@ void initTimeManagment(SearchInfo* info, Limits* limits){
 
     info->bestMoveChanges = 0; // Clear our stability time usage heuristic
 
+    info->effortScale = 1.0; // No node effort information until we search
+
     // Allocate time if Ethereal is handling the clock
     if (limits->limitedBySelf){
 
@@ -78,9 +86,9 @@ void initTimeManagment(SearchInfo* info, Limits* limits){
         }
 
         // Cap all time allocations using the move time buffer
-        info->idealUsage = MIN(info->idealUsage, limits->time - MoveOverhead);
-        info->maxAlloc   = MIN(info->maxAlloc,   limits->time - MoveOverhead);
-        info->maxUsage   = MIN(info->maxUsage,   limits->time - MoveOverhead);
+        info->idealUsage = MIN(info->idealUsage, limits->time - moveOverhead());
+        info->maxAlloc   = MIN(info->maxAlloc,   limits->time - moveOverhead());
+        info->maxUsage   = MIN(info->maxUsage,   limits->time - moveOverhead());
     }
 
     // Interface told us to search for a predefined duration
@@ -142,6 +150,84 @@ void updateTimeManagment(SearchInfo* info, Limits* limits, int depth, int value)
         info->bestMoveChanges = 6;
     }
 
+    // Scale our time by the share of root nodes spent on the best move. When
+    // one move takes nearly all of the effort, the others are refuted easily
+    // and we can stop early. When the effort is split, the choice is harder.
+    // The scale replaces the one from the last iteration, rather than adding
+    // to it, so that a dominant best move does not shrink our time each depth
+    double effortScale = MAX(0.60, MIN(1.60, (1.50 - info->bestMoveEffort[depth]) * 1.30));
+    info->idealUsage *= effortScale / info->effortScale;
+    info->effortScale = effortScale;
+
     // Cap our ideal usage using our maximum allocation
     info->idealUsage = MIN(info->idealUsage, info->maxAlloc);
-}
\ No newline at end of file
+}
+
+void ponderHitTimeManagment(SearchInfo* info, Limits* limits){
+
+    // Our clock only started running on the ponderhit, so every hard limit is
+    // pushed back by the time spent pondering. The ideal usage is left alone,
+    // as that time was already spent searching this very position, and a long
+    // enough ponder should let us reply as soon as the iteration completes
+    double pondered = elapsedTime(info);
+
+    if (limits->limitedBySelf){
+        info->maxAlloc += pondered;
+        info->maxUsage += pondered;
+    }
+
+    // Interface told us to search for a predefined duration after the ponderhit
+    if (limits->limitedByTime){
+        limits->timeLimit += pondered;
+        info->idealUsage   = limits->timeLimit;
+        info->maxAlloc     = limits->timeLimit;
+        info->maxUsage     = limits->timeLimit;
+    }
+}
+
+double moveOverhead(){
+
+    // Use the MoveOverhead option until the interface has been measured. After
+    // that, allow for half again the lag we have seen, plus a fixed 10ms, but
+    // never less than the option, so measuring can only add to its safety
+    if (!AutoMoveOverhead || MeasuredLag < 0)
+        return MoveOverhead;
+
+    return MAX(MoveOverhead, 10 + 1.5 * MeasuredLag);
+}
+
+void updateMoveOverhead(Limits* limits){
+
+    // The interface charged our clock for the last move by however much it
+    // dropped, after the increment was added back. Whatever we did not spend
+    // ourselves, between the go and the bestmove, was lost to the interface
+    if (LastClock >= 0 && limits->limitedBySelf){
+
+        double charged = LastClock - (limits->time - limits->inc);
+        double lag     = MAX(0, charged - LastElapsed);
+
+        // A clock which grew was refilled by movestogo, so tells us nothing.
+        // Otherwise move halfway to a larger lag, so that a lone outlier is
+        // not taken in full, and let a smaller one decay in slowly
+        if (charged >= 0)
+            MeasuredLag = MeasuredLag < 0  ? lag
+                        : lag > MeasuredLag ? 0.50 * MeasuredLag + 0.50 * lag
+                        :                     0.90 * MeasuredLag + 0.10 * lag;
+    }
+
+    LastClock = -1;
+}
+
+void recordMoveTime(Limits* limits, double elapsed, int pondered){
+
+    // A ponder search only starts our clock on the ponderhit, so the time
+    // from the go to the bestmove is not what the interface charges us
+    LastClock   = limits->limitedBySelf && !pondered ? limits->time : -1;
+    LastElapsed = elapsed;
+}
+
+void newGameMoveOverhead(){
+
+    // The lag belongs to the session, but the clocks belong to the game
+    LastClock = -1;
+}
@@ -25,5 +25,10 @@ double getRealTime();
 double elapsedTime(SearchInfo* info);
 void initTimeManagment(SearchInfo* info, Limits* limits);
 void updateTimeManagment(SearchInfo* info, Limits* limits, int depth, int value);
+void ponderHitTimeManagment(SearchInfo* info, Limits* limits);
+double moveOverhead();
+void updateMoveOverhead(Limits* limits);
+void recordMoveTime(Limits* limits, double elapsed, int pondered);
+void newGameMoveOverhead();
 
 #endif
@@ -43,7 +43,8 @@ enum {
 
 enum {
     MAX_PLY = 128,
-    MAX_MOVES = 256
+    MAX_MOVES = 256,
+    MAX_MULTIPV = 64
 };
 
 enum {
@@ -94,8 +95,11 @@ typedef struct Undo Undo;
 typedef struct EvalTrace EvalTrace;
 typedef struct EvalInfo EvalInfo;
 typedef struct MovePicker MovePicker;
+typedef struct NNUEAccumulator NNUEAccumulator;
 typedef struct SearchInfo SearchInfo;
 typedef struct PVariation PVariation;
+typedef struct RootMove RootMove;
+typedef struct SearchStack SearchStack;
 typedef struct TexelTuple TexelTuple;
 typedef struct TexelEntry TexelEntry;
 typedef struct Thread Thread;
@@ -114,3 +118,4 @@ typedef uint16_t CounterMoveTable[COLOUR_NB][PIECE_NB][SQUARE_NB];
 typedef int16_t HistoryTable[COLOUR_NB][SQUARE_NB][SQUARE_NB];
 typedef int16_t CMHistoryTable[PIECE_NB][SQUARE_NB][PIECE_NB][SQUARE_NB];
 typedef int16_t FUHistoryTable[PIECE_NB][SQUARE_NB][PIECE_NB][SQUARE_NB];
+typedef int16_t CaptureHistoryTable[PIECE_NB][SQUARE_NB][PIECE_NB];
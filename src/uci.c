@@ -22,8 +22,10 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
 #include "attacks.h"
+#include "bench.h"
 #include "board.h"
 #include "evaluate.h"
 #include "fathom/tbprobe.h"
@@ -31,6 +33,7 @@
 #include "masks.h"
 #include "move.h"
 #include "movegen.h"
+#include "nnue.h"
 #include "psqt.h"
 #include "search.h"
 #include "texel.h"
@@ -44,19 +47,48 @@
 
 extern int MoveOverhead; // Defined by Time.c
 
+extern int AutoMoveOverhead; // Defined by Time.c
+
+extern int MultiPV; // Defined by Search.c
+
 extern unsigned TB_PROBE_DEPTH; // Defined by Syzygy.c
 
 extern volatile int ABORT_SIGNAL; // For killing active search
 
-pthread_mutex_t READYLOCK = PTHREAD_MUTEX_INITIALIZER;
+extern volatile int IS_PONDERING; // For swapping out of PONDER
+
+// Commands which must wait their turn, queued for the main thread by uciInput()
+static struct { char str[8192]; double received; } Commands[UCI_QUEUE_SIZE];
+static int CommandHead, CommandCount, CommandBusy;
+static pthread_mutex_t CommandLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t CommandSignal = PTHREAD_COND_INITIALIZER;
+
+// Searches queued, started, and covered by the last stop and ponderhit. A stop
+// or ponderhit may arrive before its go has left the queue, and is kept here
+static uint64_t GosIssued, GosStarted, GosStopped, GosPonderHit;
+
+// Signalled, under CommandLock, whenever a ponderhit, stop or quit clears
+// IS_PONDERING, for a ponder search which finished before being resolved
+static pthread_cond_t PonderSignal = PTHREAD_COND_INITIALIZER;
+
+int InfoInterval = 50; // Set by UCI options
+int QuietInfo = 0; // Set by the benchmark suite
+
+// Info lines waiting on uciOutput(), only the newest kept for each PV slot
+static char PendingInfo[MAX_MULTIPV][UCI_INFO_SIZE];
+static int PendingSlots[MAX_MULTIPV], PendingCount, OutputRunning;
+static double LastInfoWrite;
+static pthread_mutex_t InfoLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t InfoSignal = PTHREAD_COND_INITIALIZER;
 
 
 int main(int argc, char **argv) {
 
     Board board;
-    char str[8192], *ptr;
+    char str[8192];
+    double received;
     ThreadsGo threadsgo;
-    pthread_t pthreadsgo;
+    pthread_t pthreadinput, pthreadoutput;
 
     int nthreads = argc > 3 ? atoi(argv[3]) : 1;
     int megabytes = argc > 4 ? atoi(argv[4]) : 16;
@@ -68,6 +100,13 @@ int main(int argc, char **argv) {
     initZobrist();
     initSearch();
 
+    // Given key=value options, bench runs the benchmark suite, which builds
+    // its own Hash table and threads and reports its results as JSON
+    if (argc > 2 && stringEquals(argv[1], "bench") && strchr(argv[2], '=')) {
+        runBenchmarkSuite(argc - 2, argv + 2);
+        return 0;
+    }
+
     // Default to 16MB TT
     initTT(megabytes);
 
@@ -83,13 +122,36 @@ int main(int argc, char **argv) {
     #endif
 
     if (argc > 1 && stringEquals(argv[1], "bench")) {
-        runBenchmark(threads, argc > 2 ? atoi(argv[2]) : 0);
+        runBenchmark(threads, argc > 2 ? atoi(argv[2]) : 0, 0);
         return 0;
     }
 
+    if (argc > 1 && stringEquals(argv[1], "nodebench")) {
+        runBenchmark(threads, 0, argc > 2 ? strtoull(argv[2], NULL, 10) : 250000);
+        return 0;
+    }
+
+    if (argc > 1 && stringEquals(argv[1], "microbench")) {
+        runMicroBenchmark(argc > 2 ? atoi(argv[2]) : 0);
+        return 0;
+    }
+
+    if (argc > 1 && stringEquals(argv[1], "evalcheck")) {
+        runEvalCheck(argc > 2 ? atoi(argv[2]) : 0);
+        return 0;
+    }
+
+    // Commands are read on their own thread, so that the interface is always
+    // heard while we search. The main thread runs everything else in order
+    pthread_create(&pthreadinput, NULL, &uciInput, NULL);
+
+    // Info lines are written by their own thread too, at a limited rate
+    OutputRunning = 1;
+    pthread_create(&pthreadoutput, NULL, &uciOutput, NULL);
+
     while (1){
 
-        getInput(str);
+        received = uciNextCommand(str);
 
         if (stringEquals(str, "uci")){
             printf("id name Ethereal " ETHEREAL_VERSION "\n");
@@ -97,70 +159,43 @@ int main(int argc, char **argv) {
             printf("option name Hash type spin default 16 min 1 max 65536\n");
             printf("option name Threads type spin default 1 min 1 max 2048\n");
             printf("option name MoveOverhead type spin default 100 min 0 max 10000\n");
+            printf("option name AutoMoveOverhead type check default true\n");
+            printf("option name MultiPV type spin default 1 min 1 max %d\n", MAX_MULTIPV);
+            printf("option name InfoInterval type spin default 50 min 0 max 5000\n");
             printf("option name SyzygyPath type string default <empty>\n");
             printf("option name SyzygyProbeDepth type spin default 0 min 0 max 127\n");
+            printf("option name EvalFile type string default <empty>\n");
+            printf("option name UseNNUE type check default false\n");
+            printf("option name Ponder type check default false\n");
+            printf("option name SliderAttacks type combo default Auto var Auto var Magic var PEXT var Compact\n");
+            printf("info string Using %s slider attacks\n", SliderNames[getSliderMode()]);
             printf("uciok\n");
             fflush(stdout);
         }
 
         else if (stringEquals(str, "isready")){
-            pthread_mutex_lock(&READYLOCK);
             printf("readyok\n");
             fflush(stdout);
-            pthread_mutex_unlock(&READYLOCK);
         }
 
-        else if (stringStartsWith(str, "setoption")){
-
-            if (stringStartsWith(str, "setoption name Hash value ")){
-                megabytes = atoi(str + strlen("setoption name Hash value "));
-                initTT(megabytes);
-                printf("info string set Hash to %dMB\n", megabytes);
-            }
-
-            if (stringStartsWith(str, "setoption name Threads value ")){
-                free(threads);
-                nthreads = atoi(str + strlen("setoption name Threads value "));
-                threads = createThreadPool(nthreads);
-                printf("info string set Threads to %d\n", nthreads);
-            }
-
-            if (stringStartsWith(str, "setoption name MoveOverhead value ")){
-                MoveOverhead = atoi(str + strlen("setoption name MoveOverhead value "));
-                printf("info string set MoveOverhead to %d\n", MoveOverhead);
-            }
-
-            if (stringStartsWith(str, "setoption name SyzygyPath value ")){
-                ptr = str + strlen("setoption name SyzygyPath value ");
-                tb_init(ptr); printf("info string set SyzygyPath to %s\n", ptr);
-            }
-
-            if (stringStartsWith(str, "setoption name SyzygyProbeDepth value ")){
-                TB_PROBE_DEPTH = atoi(str + strlen("setoption name SyzygyProbeDepth value "));
-                printf("info string set SyzygyProbeDepth to %u\n", TB_PROBE_DEPTH);
-            }
-
-            fflush(stdout);
-        }
+        else if (stringStartsWith(str, "setoption"))
+            uciSetOption(str, &threads);
 
         else if (stringEquals(str, "ucinewgame")){
             resetThreadPool(threads);
             clearTT();
+            newGameMoveOverhead();
         }
 
         else if (stringStartsWith(str, "position"))
             uciPosition(str, &board);
 
         else if (stringStartsWith(str, "go")){
-            strncpy(threadsgo.str, str, 512);
+            strcpy(threadsgo.str, str);
             threadsgo.threads = threads;
             threadsgo.board = &board;
-            pthread_create(&pthreadsgo, NULL, &uciGo, &threadsgo);
-        }
-
-        else if (stringEquals(str, "stop")){
-            ABORT_SIGNAL = 1;
-            pthread_join(pthreadsgo, NULL);
+            threadsgo.start = received;
+            uciGo(&threadsgo);
         }
 
         else if (stringEquals(str, "quit"))
@@ -180,13 +215,296 @@ int main(int argc, char **argv) {
     return 0;
 }
 
-void* uciGo(void* vthreadsgo){
+void uciSetOption(char* str, Thread** threads){
+
+    int megabytes, nthreads;
+    char* ptr;
+
+    if (stringStartsWith(str, "setoption name Hash value ")){
+        megabytes = atoi(str + strlen("setoption name Hash value "));
+        initTT(megabytes);
+        printf("info string set Hash to %dMB\n", megabytes);
+    }
+
+    if (stringStartsWith(str, "setoption name Threads value ")){
+        free(*threads);
+        nthreads = atoi(str + strlen("setoption name Threads value "));
+        *threads = createThreadPool(nthreads);
+        printf("info string set Threads to %d\n", nthreads);
+    }
+
+    if (stringStartsWith(str, "setoption name MoveOverhead value ")){
+        MoveOverhead = atoi(str + strlen("setoption name MoveOverhead value "));
+        printf("info string set MoveOverhead to %d\n", MoveOverhead);
+    }
+
+    if (stringStartsWith(str, "setoption name AutoMoveOverhead value ")){
+        AutoMoveOverhead = stringEquals(str + strlen("setoption name AutoMoveOverhead value "), "true");
+        printf("info string set AutoMoveOverhead to %s\n", AutoMoveOverhead ? "true" : "false");
+    }
+
+    if (stringStartsWith(str, "setoption name MultiPV value ")){
+        MultiPV = atoi(str + strlen("setoption name MultiPV value "));
+        MultiPV = MAX(1, MIN(MAX_MULTIPV, MultiPV));
+        printf("info string set MultiPV to %d\n", MultiPV);
+    }
+
+    if (stringStartsWith(str, "setoption name InfoInterval value ")){
+        InfoInterval = atoi(str + strlen("setoption name InfoInterval value "));
+        InfoInterval = MAX(0, MIN(5000, InfoInterval));
+        printf("info string set InfoInterval to %d\n", InfoInterval);
+    }
+
+    if (stringStartsWith(str, "setoption name SyzygyPath value ")){
+        ptr = str + strlen("setoption name SyzygyPath value ");
+        tb_init(ptr); printf("info string set SyzygyPath to %s\n", ptr);
+    }
+
+    if (stringStartsWith(str, "setoption name SyzygyProbeDepth value ")){
+        TB_PROBE_DEPTH = atoi(str + strlen("setoption name SyzygyProbeDepth value "));
+        printf("info string set SyzygyProbeDepth to %u\n", TB_PROBE_DEPTH);
+    }
+
+    if (stringStartsWith(str, "setoption name EvalFile value ")){
+        ptr = str + strlen("setoption name EvalFile value ");
+        if (nnueLoad(ptr)) printf("info string set EvalFile to %s\n", ptr);
+        else printf("info string unable to load EvalFile %s\n", ptr);
+    }
+
+    if (stringStartsWith(str, "setoption name UseNNUE value ")){
+        UseNNUE = stringEquals(str + strlen("setoption name UseNNUE value "), "true");
+        printf("info string set UseNNUE to %s (%s kernels)\n", UseNNUE ? "true" : "false", nnueKernel());
+        if (UseNNUE && !nnueIsLoaded())
+            printf("info string no EvalFile loaded, using the classical evaluation\n");
+    }
+
+    if (stringStartsWith(str, "setoption name Ponder value ")){
+        ptr = str + strlen("setoption name Ponder value ");
+        printf("info string set Ponder to %s\n", ptr);
+    }
+
+    if (stringStartsWith(str, "setoption name SliderAttacks value ")){
+        ptr = str + strlen("setoption name SliderAttacks value ");
+        int mode = -1;
+        for (int i = 0; i < SLIDER_NB; i++)
+            if (stringEquals(ptr, (char*)SliderNames[i])) mode = i;
+        if (mode == -1) setSliderMode(selectSliderMode());
+        else if (sliderModeSupported(mode)) setSliderMode(mode);
+        else printf("info string %s is not supported by this build or host\n", ptr);
+        printf("info string set SliderAttacks to %s\n", SliderNames[getSliderMode()]);
+    }
+
+    fflush(stdout);
+}
+
+static int uciOptionIsImmediate(char* str){
+
+    // Options which no search depends on mid-flight, safe to set at any time
+    return stringStartsWith(str, "setoption name MoveOverhead value ")
+        || stringStartsWith(str, "setoption name AutoMoveOverhead value ")
+        || stringStartsWith(str, "setoption name MultiPV value ")
+        || stringStartsWith(str, "setoption name InfoInterval value ")
+        || stringStartsWith(str, "setoption name Ponder value ")
+        || stringStartsWith(str, "setoption name SyzygyProbeDepth value ");
+}
+
+static int uciCommandsIdle(){
+
+    // Called with CommandLock held. A queued go holds up nothing, since a
+    // search is answered for while it runs, but other commands are run in
+    // order, and a busy main thread, such as when setting the Hash size, is
+    // a command which an isready must wait for
+    if (CommandBusy) return 0;
+
+    for (int i = 0; i < CommandCount; i++)
+        if (!stringStartsWith(Commands[(CommandHead + i) % UCI_QUEUE_SIZE].str, "go"))
+            return 0;
+
+    return 1;
+}
+
+void* uciInput(void* vnull){
+
+    char str[8192];
+
+    (void) vnull;
+
+    while (1){
+
+        getInput(str);
+
+        pthread_mutex_lock(&CommandLock);
+
+        // With nothing but searches ahead of it, a command may be answered
+        // right away, even while searching
+        int idle = uciCommandsIdle();
+
+        if (stringEquals(str, "isready") && idle){
+            printf("readyok\n");
+            fflush(stdout);
+        }
+
+        else if (stringEquals(str, "stop")){
+            GosStopped = GosIssued;
+            IS_PONDERING = 0;
+            ABORT_SIGNAL = 1;
+            pthread_cond_broadcast(&PonderSignal);
+        }
+
+        else if (stringEquals(str, "ponderhit")){
+            GosPonderHit = GosIssued;
+            IS_PONDERING = 0;
+            pthread_cond_broadcast(&PonderSignal);
+        }
+
+        else if (idle && uciOptionIsImmediate(str))
+            uciSetOption(str, NULL);
+
+        else {
+
+            if (stringStartsWith(str, "go"))
+                GosIssued++;
+
+            // Quitting ends any search, the same as a stop would
+            if (stringEquals(str, "quit")){
+                GosStopped = GosIssued;
+                IS_PONDERING = 0;
+                ABORT_SIGNAL = 1;
+                pthread_cond_broadcast(&PonderSignal);
+            }
+
+            while (CommandCount == UCI_QUEUE_SIZE)
+                pthread_cond_wait(&CommandSignal, &CommandLock);
+
+            int index = (CommandHead + CommandCount++) % UCI_QUEUE_SIZE;
+            strcpy(Commands[index].str, str);
+            Commands[index].received = getRealTime();
+            pthread_cond_broadcast(&CommandSignal);
+        }
+
+        pthread_mutex_unlock(&CommandLock);
+
+        if (stringEquals(str, "quit"))
+            return NULL;
+    }
+}
+
+double uciNextCommand(char* str){
+
+    pthread_mutex_lock(&CommandLock);
+
+    // We finished our last command, so the input thread may answer for us
+    CommandBusy = 0;
+
+    while (!CommandCount)
+        pthread_cond_wait(&CommandSignal, &CommandLock);
+
+    strcpy(str, Commands[CommandHead].str);
+    double received = Commands[CommandHead].received;
+    CommandHead = (CommandHead + 1) % UCI_QUEUE_SIZE;
+    CommandCount--;
+
+    // A search keeps us busy, but leaves the input thread free to answer.
+    // Clear the ABORT signal and set up pondering, unless a stop or ponderhit
+    // for this search arrived while it was still queued
+    if (stringStartsWith(str, "go")){
+        GosStarted++;
+        if (GosStarted > GosStopped) ABORT_SIGNAL = 0;
+        IS_PONDERING = stringContains(str, "ponder") && GosStarted > GosPonderHit;
+
+        // An isready queued behind this go waited only on the commands before
+        // it, which are now done, so it need not wait on the search as well
+        while (CommandCount && stringEquals(Commands[CommandHead].str, "isready")){
+            printf("readyok\n");
+            fflush(stdout);
+            CommandHead = (CommandHead + 1) % UCI_QUEUE_SIZE;
+            CommandCount--;
+        }
+    }
+
+    else CommandBusy = 1;
+
+    pthread_cond_broadcast(&CommandSignal);
+    pthread_mutex_unlock(&CommandLock);
+
+    return received;
+}
+
+static void writePendingInfo(){
+
+    // Called with InfoLock held. Lines go out in PV order, with one flush
+    for (int slot = 0; slot < MAX_MULTIPV && PendingCount; slot++){
+        if (!PendingSlots[slot]) continue;
+        puts(PendingInfo[slot]);
+        PendingSlots[slot] = 0;
+        PendingCount--;
+    }
+
+    fflush(stdout);
+    LastInfoWrite = getRealTime();
+}
+
+void* uciOutput(void* vnull){
+
+    struct timespec deadline;
+    double remaining;
+
+    (void) vnull;
+
+    pthread_mutex_lock(&InfoLock);
+
+    while (1){
+
+        while (!PendingCount)
+            pthread_cond_wait(&InfoSignal, &InfoLock);
+
+        // Hold the lines back until InfoInterval has passed since our last
+        // write. Newer lines replace older ones for the same slot meanwhile
+        while (PendingCount && (remaining = LastInfoWrite + InfoInterval - getRealTime()) > 0){
+            clock_gettime(CLOCK_REALTIME, &deadline);
+            deadline.tv_nsec += (long)(remaining * 1e6);
+            deadline.tv_sec  += deadline.tv_nsec / 1000000000;
+            deadline.tv_nsec %= 1000000000;
+            pthread_cond_timedwait(&InfoSignal, &InfoLock, &deadline);
+        }
+
+        if (PendingCount) writePendingInfo();
+    }
+
+    return NULL;
+}
+
+void uciQueueInfo(int slot, char* line){
+
+    pthread_mutex_lock(&InfoLock);
 
-    // Get our starting time as soon as possible
-    double start = getRealTime();
+    // Without an output thread, as when running bench, write at once. The
+    // benchmark suite reports only its own results, and so writes nothing
+    if (!OutputRunning){
+        if (!QuietInfo) puts(line);
+        fflush(stdout);
+    }
+
+    else {
+        PendingCount += !PendingSlots[slot];
+        PendingSlots[slot] = 1;
+        strcpy(PendingInfo[slot], line);
+        pthread_cond_signal(&InfoSignal);
+    }
 
-    // Grab the ready lock, as we cannot be ready until we finish this search
-    pthread_mutex_lock(&READYLOCK);
+    pthread_mutex_unlock(&InfoLock);
+}
+
+void uciFlushInfo(){
+    pthread_mutex_lock(&InfoLock);
+    if (PendingCount) writePendingInfo();
+    pthread_mutex_unlock(&InfoLock);
+}
+
+void* uciGo(void* vthreadsgo){
+
+    // Timed from when the go was read, not from when it left the queue
+    double start = ((ThreadsGo*)vthreadsgo)->start;
 
     char* str       = ((ThreadsGo*)vthreadsgo)->str;
     Board* board    = ((ThreadsGo*)vthreadsgo)->board;
@@ -194,10 +512,17 @@ void* uciGo(void* vthreadsgo){
 
     Limits limits; limits.start = start;
 
-    int depth = -1, infinite = -1;
+    int depth = -1, infinite = -1, mate = -1, searchmoves = 0;
+    uint64_t nodes = 0;
+
+    int size = 0; uint16_t moves[MAX_MOVES];
+    genAllLegalMoves(board, moves, &size);
+    limits.searchMoveCount = 0;
     double wtime = -1, btime = -1, mtg = -1, movetime = -1;
     double winc = 0, binc = 0;
 
+    int pondered = 0;
+
     char* ptr = strtok(str, " ");
 
     // Parse time control and search type parameters
@@ -224,35 +549,98 @@ void* uciGo(void* vthreadsgo){
         else if (stringEquals(ptr, "movetime"))
             movetime = (double)(atoi(strtok(NULL, " ")));
 
+        else if (stringEquals(ptr, "nodes"))
+            nodes = strtoull(strtok(NULL, " "), NULL, 10);
+
+        else if (stringEquals(ptr, "mate"))
+            mate = atoi(strtok(NULL, " "));
+
+        else if (stringEquals(ptr, "searchmoves"))
+            searchmoves = 1;
+
         else if (stringEquals(ptr, "infinite"))
             infinite = 1;
+
+        else if (stringEquals(ptr, "ponder"))
+            pondered = 1;
+
+        // Any other token following searchmoves is a root move. Keep those
+        // which are legal, and search all moves if none of them are
+        else if (searchmoves)
+            uciAddSearchMove(&limits, ptr, moves, size);
     }
 
     // Initialize limits for the search
     limits.limitedByNone  = infinite != -1;
     limits.limitedByTime  = movetime != -1;
     limits.limitedByDepth = depth    != -1;
-    limits.limitedBySelf  = depth == -1 && movetime == -1 && infinite == -1;
+    limits.limitedByNodes = nodes    !=  0;
+    limits.limitedByMate  = mate     != -1;
+    limits.limitedBySelf  = depth == -1 && movetime == -1 && infinite == -1 && nodes == 0 && mate == -1;
     limits.timeLimit      = movetime;
     limits.depthLimit     = depth;
+    limits.nodeLimit      = nodes;
+    limits.mateLimit      = mate;
 
     // Pick the time values for the colour we are playing as
     limits.time = (board->turn == WHITE) ? wtime : btime;
     limits.mtg  = (board->turn == WHITE) ?   mtg :   mtg;
     limits.inc  = (board->turn == WHITE) ?  winc :  binc;
 
-    // Execute the search and report the best move
-    char moveStr[6];
-    moveToString(getBestMove(threads, board, &limits), moveStr);
-    printf("bestmove %s\n", moveStr);
+    // Learn how much time the interface took from us on our last move
+    updateMoveOverhead(&limits);
+
+    // Execute the search and report the best move, along with the
+    // reply we expect, which the interface may have us ponder on
+    uint16_t bestMove, ponderMove;
+    char moveStr[6], ponderStr[6];
+
+    bestMove = getBestMove(threads, board, &limits, &ponderMove);
+    moveToString(bestMove, moveStr);
+
+    // A move may not be reported until the ponder search is resolved, by
+    // either a ponderhit or a stop, even when the search itself has finished
+    pthread_mutex_lock(&CommandLock);
+    while (IS_PONDERING)
+        pthread_cond_wait(&PonderSignal, &CommandLock);
+    pthread_mutex_unlock(&CommandLock);
+
+    // The final PV may still be waiting to be written, and must come first
+    uciFlushInfo();
+
+    if (ponderMove != NONE_MOVE) {
+        moveToString(ponderMove, ponderStr);
+        printf("bestmove %s ponder %s\n", moveStr, ponderStr);
+    }
+
+    else printf("bestmove %s\n", moveStr);
+
     fflush(stdout);
 
-    // Drop the ready lock, as we are prepared to handle a new search
-    pthread_mutex_unlock(&READYLOCK);
+    // Our side of the time spent on this move, for measuring the interface
+    recordMoveTime(&limits, getRealTime() - start, pondered);
 
     return NULL;
 }
 
+void uciAddSearchMove(Limits* limits, char* str, uint16_t* moves, int size){
+
+    char moveStr[6];
+
+    for (int i = 0; i < size; i++){
+
+        moveToString(moves[i], moveStr);
+        if (!stringEquals(moveStr, str)) continue;
+
+        // Ignore a move which the interface has already given us
+        for (int j = 0; j < limits->searchMoveCount; j++)
+            if (limits->searchMoves[j] == moves[i]) return;
+
+        limits->searchMoves[limits->searchMoveCount++] = moves[i];
+        return;
+    }
+}
+
 void uciPosition(char* str, Board* board){
 
     int size;
@@ -304,9 +692,12 @@ void uciPosition(char* str, Board* board){
     }
 }
 
-void uciReport(Thread* threads, int alpha, int beta, int value){
+void uciReport(Thread* threads, int slot, int alpha, int beta){
 
-    PVariation* pv  = &threads[0].pv;
+    uint16_t* line  = threads[0].rootMoves[slot].line;
+    int length      = threads[0].rootMoves[slot].length;
+    int value       = threads[0].rootMoves[slot].value;
+    int multiPVs    = threads[0].info->multiPVs;
     int hashfull    = hashfullTT();
     int depth       = threads[0].depth;
     int seldepth    = threads[0].seldepth;
@@ -329,20 +720,27 @@ void uciReport(Thread* threads, int alpha, int beta, int value){
     char* bound = value >=  beta ? " lowerbound "
                 : value <= alpha ? " upperbound " : " ";
 
-    // Main chunk of interface reporting
-    printf("info depth %d seldepth %d score %s %d%stime %d "
+    // The line is built up and then written at once, so that nothing the
+    // input thread writes, such as a readyok, can land in the middle of it
+    char buffer[UCI_INFO_SIZE], *ptr = buffer;
+
+    // Main chunk of interface reporting. The multipv field is only
+    // given when searching more than one PV, to match older output
+    ptr += sprintf(ptr, "info depth %d seldepth %d", depth, seldepth);
+    if (multiPVs > 1) ptr += sprintf(ptr, " multipv %d", slot + 1);
+    ptr += sprintf(ptr, " score %s %d%stime %d "
            "nodes %"PRIu64" nps %d tbhits %"PRIu64" hashfull %d pv ",
-           depth, seldepth, type, score, bound, elapsed, nodes, nps, tbhits, hashfull);
+           type, score, bound, elapsed, nodes, nps, tbhits, hashfull);
 
-    // Iterate over the PV and print each move
-    for (int i = 0; i < pv->length; i++){
-        char moveStr[6];
-        moveToString(pv->line[i], moveStr);
-        printf("%s ", moveStr);
+    // Iterate over the PV and add each move
+    for (int i = 0; i < length; i++){
+        moveToString(line[i], ptr);
+        ptr += strlen(ptr);
+        *ptr++ = ' ';
     }
 
-    puts("");
-    fflush(stdout);
+    *ptr = '\0';
+    uciQueueInfo(slot, buffer);
 }
 
 void uciReportTBRoot(uint16_t move, unsigned wdl, unsigned dtz){
@@ -350,13 +748,12 @@ void uciReportTBRoot(uint16_t move, unsigned wdl, unsigned dtz){
     int score = wdl == TB_LOSS ? -MATE + MAX_PLY + dtz + 1
               : wdl == TB_WIN  ?  MATE - MAX_PLY - dtz - 1 : 0;
 
-    printf("info depth %d seldepth %d score cp %d time 0 "
-           "nodes 0 tbhits 1 nps 0 hashfull %d pv ",
-           MAX_PLY - 1, MAX_PLY - 1, score, 0);
-
     char moveStr[6];
     moveToString(move, moveStr);
-    puts(moveStr);
+
+    printf("info depth %d seldepth %d score cp %d time 0 "
+           "nodes 0 tbhits 1 nps 0 hashfull %d pv %s\n",
+           MAX_PLY - 1, MAX_PLY - 1, score, 0, moveStr);
     fflush(stdout);
 }
 
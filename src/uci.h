@@ -23,8 +23,12 @@
 
 #define VERSION_ID "10.83"
 
-#if defined(USE_PEXT)
+#if defined(DISPATCH_LEVEL)
+    #define ETHEREAL_VERSION VERSION_ID" ("DISPATCH_LEVEL")"
+#elif defined(USE_PEXT)
     #define ETHEREAL_VERSION VERSION_ID" (PEXT)"
+#elif defined(USE_POPCNT) && defined(__AVX2__)
+    #define ETHEREAL_VERSION VERSION_ID" (AVX2)"
 #elif defined(USE_POPCNT)
     #define ETHEREAL_VERSION VERSION_ID" (POPCNT)"
 #else
@@ -34,20 +38,29 @@
 struct Limits {
     int depthLimit;
     double timeLimit;
+    uint64_t nodeLimit;
+    int mateLimit;
     int limitedByNone;
     int limitedByTime;
     int limitedByDepth;
+    int limitedByNodes;
+    int limitedByMate;
     int limitedBySelf;
+    int searchMoveCount;
+    uint16_t searchMoves[MAX_MOVES];
     double start;
     double time;
     double inc;
     double mtg;
 };
 
+enum { UCI_QUEUE_SIZE = 32, UCI_INFO_SIZE = 256 + 6 * (MAX_PLY + 1) };
+
 struct ThreadsGo {
-    char str[512];
+    char str[8192];
     Thread* threads;
     Board* board;
+    double start;
 };
 
 void getInput(char* str);
@@ -55,9 +68,16 @@ int stringEquals(char* s1, char* s2);
 int stringStartsWith(char* str, char* key);
 int stringContains(char* str, char* key);
 
+void uciSetOption(char* str, Thread** threads);
+void* uciInput(void* vnull);
+double uciNextCommand(char* str);
+void* uciOutput(void* vnull);
+void uciQueueInfo(int slot, char* line);
+void uciFlushInfo();
 void* uciGo(void* vthreadgo);
+void uciAddSearchMove(Limits* limits, char* str, uint16_t* moves, int size);
 void uciPosition(char* str, Board* board);
-void uciReport(Thread* threads, int alpha, int beta, int value);
+void uciReport(Thread* threads, int slot, int alpha, int beta);
 void uciReportTBRoot(uint16_t move, unsigned wdl, unsigned dtz);
 
 #endif
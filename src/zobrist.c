@@ -19,7 +19,10 @@
 #include <stdlib.h>
 #include <stdint.h>
 
+#include "attacks.h"
+#include "bitboards.h"
 #include "castle.h"
+#include "move.h"
 #include "types.h"
 #include "zobrist.h"
 
@@ -28,6 +31,9 @@ uint64_t ZobristEnpassKeys[FILE_NB];
 uint64_t ZobristCastleKeys[0x10];
 uint64_t ZobristTurnKey;
 
+uint64_t CuckooKeys[CUCKOO_SIZE];
+uint16_t CuckooMoves[CUCKOO_SIZE];
+
 static uint64_t rand64() {
 
     // http://vigna.di.unimi.it/ftp/papers/xorshift.pdf
@@ -79,4 +85,43 @@ void initZobrist() {
 
     // Init the Zobrist key for side to move
     ZobristTurnKey = rand64();
+
+    // Init the Cuckoo tables, which hold the Zobrist difference of every
+    // reversible move on an empty board, keyed by two independent hashes
+    for (int pt = KNIGHT; pt <= KING; pt++) {
+        for (int colour = WHITE; colour <= BLACK; colour++) {
+            for (int s1 = 0; s1 < SQUARE_NB; s1++) {
+
+                uint64_t attacks = pt == KNIGHT ? knightAttacks(s1)
+                                 : pt == BISHOP ? bishopAttacks(s1, 0ull)
+                                 : pt == ROOK   ? rookAttacks(s1, 0ull)
+                                 : pt == QUEEN  ? queenAttacks(s1, 0ull)
+                                                : kingAttacks(s1);
+
+                for (int s2 = s1 + 1; s2 < SQUARE_NB; s2++) {
+
+                    if (!testBit(attacks, s2))
+                        continue;
+
+                    int piece = makePiece(pt, colour);
+                    uint16_t move = MoveMake(s1, s2, NORMAL_MOVE);
+                    uint64_t key = ZobristKeys[piece][s1]
+                                 ^ ZobristKeys[piece][s2]
+                                 ^ ZobristTurnKey;
+
+                    // Insert, displacing entries until an empty slot is found
+                    for (int i = cuckooHash1(key); move != NONE_MOVE;) {
+
+                        uint64_t tempKey = CuckooKeys[i];
+                        uint16_t tempMove = CuckooMoves[i];
+
+                        CuckooKeys[i] = key, key = tempKey;
+                        CuckooMoves[i] = move, move = tempMove;
+
+                        i = i == cuckooHash1(key) ? cuckooHash2(key) : cuckooHash1(key);
+                    }
+                }
+            }
+        }
+    }
 }
@@ -27,4 +27,17 @@ extern uint64_t ZobristEnpassKeys[FILE_NB];
 extern uint64_t ZobristCastleKeys[0x10];
 extern uint64_t ZobristTurnKey;
 
+enum { CUCKOO_SIZE = 0x2000 };
+
+extern uint64_t CuckooKeys[CUCKOO_SIZE];
+extern uint16_t CuckooMoves[CUCKOO_SIZE];
+
 void initZobrist();
+
+static inline int cuckooHash1(uint64_t key) {
+    return (key >>  0) & (CUCKOO_SIZE - 1);
+}
+
+static inline int cuckooHash2(uint64_t key) {
+    return (key >> 16) & (CUCKOO_SIZE - 1);
+}